@@ -3,6 +3,41 @@
 #include <string>
 #include <fstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <charconv>
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <cctype>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <random>
+#include <cstdio>
+#include <set>
+#include <ctime>
+#include <climits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // ANSI color codes (works on most terminals)
 const std::string RESET = "\033[0m";
@@ -12,6 +47,685 @@ const std::string RED = "\033[31m";
 const std::string GREEN = "\033[32m";
 const std::string BLUE = "\033[34m";
 const std::string CYAN = "\033[36m";
+
+const std::string LIBRARY_DATA_FILE = "library_data.txt";
+const std::string LIBRARY_SNAPSHOT_FILE = "library_data.bin";
+const std::string LIBRARY_JOURNAL_FILE = "library_journal.bin";
+
+// Loans are due this long after issue; a renewal extends the due date by the same
+const int LOAN_PERIOD_DAYS = 14;
+const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+// Default borrowing limits (see Library::setLoanLimits): a member may hold
+// this many active loans, and may not borrow while holding more than
+// MAX_OVERDUE_LOANS overdue ones
+const int MAX_ACTIVE_LOANS = 5;
+const int MAX_OVERDUE_LOANS = 0;
+
+// Neighbours kept per book by Library::rebuildRecommendations
+const size_t RECOMMENDATIONS_PER_BOOK = 10;
+
+// Once the journal holds this many records, the next mutation saves a
+// fresh snapshot and truncates it
+const size_t JOURNAL_CHECKPOINT_RECORDS = 1000000;
+
+// Batch mode makes its changes durable, and prints their results, once per
+// this many commands
+const size_t BATCH_COMMIT_LINES = 4096;
+
+// On-disk formats understood by Library::saveData / Library::loadData
+enum class DataFormat { Text, Binary };
+
+// Outcome of Library::tryIssueBook / tryReturnBook / renewLoan
+enum class LoanStatus { Ok, MemberNotFound, BookNotFound, BookUnavailable, NoActiveLoan, LoanLimitReached,
+                        OverdueLimitReached, NotJournaled };
+
+inline const char* describe(LoanStatus status) {
+    switch (status) {
+    case LoanStatus::Ok:
+        return "OK.";
+    case LoanStatus::MemberNotFound:
+        return "Member not found.";
+    case LoanStatus::BookNotFound:
+        return "Book not found.";
+    case LoanStatus::BookUnavailable:
+        return "Book is currently unavailable.";
+    case LoanStatus::NoActiveLoan:
+        return "No active loan found for the given book and member.";
+    case LoanStatus::LoanLimitReached:
+        return "Member has reached the maximum number of active loans.";
+    case LoanStatus::OverdueLimitReached:
+        return "Member has too many overdue loans.";
+    case LoanStatus::NotJournaled:
+        return "The change could not be written to the journal; save the library to keep it.";
+    }
+    return "Unknown status.";
+}
+
+// Binary snapshot layout (native byte order):
+//   SnapshotHeader
+//   int32  bookID[books]        StringRef title[books]     StringRef author[books]
+//   int32  memberID[members]    StringRef name[members]
+//   int32  loanBookID[loans]    int32 loanMemberID[loans]
+//   int64  loanIssued[loans]    int64 loanDue[loans]       (version 2+)
+//   uint8  bookAvailable[books] uint8 loanActive[loans]
+//   char   heap[heapSize]       (title/author/name bytes)
+// The checksum covers everything after the header.
+const char SNAPSHOT_MAGIC[8] = {'L', 'I', 'B', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t generation; // pairs the snapshot with its journal
+    uint64_t bookCount;
+    uint64_t memberCount;
+    uint64_t loanCount;
+    uint64_t heapSize;
+    uint64_t checksum;
+};
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Byte offsets of each column, computed from the record counts
+struct SnapshotLayout {
+    size_t bookIDs, bookTitles, bookAuthors;
+    size_t memberIDs, memberNames;
+    size_t loanBookIDs, loanMemberIDs;
+    size_t loanIssued, loanDue;
+    size_t bookAvailable, loanActive;
+    size_t heap, end;
+
+    explicit SnapshotLayout(const SnapshotHeader& h) {
+        size_t pos = sizeof(SnapshotHeader);
+        auto column = [&pos](uint64_t count, size_t width) {
+            size_t start = pos;
+            pos += count * width;
+            return start;
+        };
+        bookIDs = column(h.bookCount, sizeof(int32_t));
+        bookTitles = column(h.bookCount, sizeof(StringRef));
+        bookAuthors = column(h.bookCount, sizeof(StringRef));
+        memberIDs = column(h.memberCount, sizeof(int32_t));
+        memberNames = column(h.memberCount, sizeof(StringRef));
+        loanBookIDs = column(h.loanCount, sizeof(int32_t));
+        loanMemberIDs = column(h.loanCount, sizeof(int32_t));
+        uint64_t datedLoans = h.version >= 2 ? h.loanCount : 0;
+        loanIssued = column(datedLoans, sizeof(int64_t));
+        loanDue = column(datedLoans, sizeof(int64_t));
+        bookAvailable = column(h.bookCount, 1);
+        loanActive = column(h.loanCount, 1);
+        heap = column(h.heapSize, 1);
+        end = pos;
+    }
+};
+
+// Word-at-a-time FNV-1a variant; fast enough to verify multi-GB snapshots
+inline uint64_t snapshotChecksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+// Streams a pipe-delimited text file in large blocks and splits each line
+// into string_view fields without allocating per field. The views stay
+// valid until the next call to next().
+class DelimitedReader {
+private:
+    std::ifstream file;
+    std::istream& input;
+    std::vector<char> buffer;
+    size_t pos = 0;          // start of the unconsumed data
+    size_t end = 0;          // end of the valid data
+    bool eof = false;
+    size_t lineNumber = 0;
+    std::vector<size_t> cuts; // '|' offsets within the current line
+    std::string_view line;
+    std::vector<std::string_view> fields;
+
+    // Index of the first '|' or '\n' in [from, end), or end if there is none
+    size_t findDelimiter(size_t from) const {
+        const char* data = buffer.data();
+#ifdef __SSE2__
+        const __m128i pipe = _mm_set1_epi8('|');
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; from + 16 <= end; from += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, pipe),
+                                                      _mm_cmpeq_epi8(chunk, newline)));
+            if (mask != 0) {
+                return from + __builtin_ctz(mask);
+            }
+        }
+#endif
+        for (; from < end; ++from) {
+            if (data[from] == '|' || data[from] == '\n') {
+                return from;
+            }
+        }
+        return end;
+    }
+
+    // Moves the partial line to the front of the buffer and reads more data
+    bool refill() {
+        if (eof) {
+            return false;
+        }
+        if (pos > 0) {
+            std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        input.read(buffer.data() + end, buffer.size() - end);
+        size_t got = static_cast<size_t>(input.gcount());
+        if (got == 0) {
+            eof = true;
+            return false;
+        }
+        end += got;
+        return true;
+    }
+
+public:
+    explicit DelimitedReader(const std::string& path, size_t blockSize = 1 << 20)
+        : file(path, std::ios::binary), input(file), buffer(blockSize) {}
+
+    explicit DelimitedReader(std::istream& in, size_t blockSize = 1 << 16)
+        : input(in), buffer(blockSize) {}
+
+    bool isOpen() const { return static_cast<bool>(input); }
+    size_t getLineNumber() const { return lineNumber; }
+    std::string_view getLine() const { return line; }
+    const std::vector<std::string_view>& getFields() const { return fields; }
+
+    // Advances to the next line. Returns false once the file is exhausted.
+    bool next() {
+        cuts.clear();
+        size_t scanned = 0; // bytes of the current line already searched
+        size_t hit;
+        while (true) {
+            hit = findDelimiter(pos + scanned);
+            if (hit == end) {
+                scanned = end - pos;
+                if (refill()) {
+                    continue;
+                }
+                if (scanned == 0) {
+                    return false;
+                }
+                hit = end; // last line has no trailing newline
+                break;
+            }
+            if (buffer[hit] == '|') {
+                cuts.push_back(hit - pos);
+                scanned = hit - pos + 1;
+                continue;
+            }
+            break;
+        }
+
+        const char* start = buffer.data() + pos;
+        size_t length = hit - pos;
+        if (length > 0 && start[length - 1] == '\r') {
+            --length;
+        }
+        line = std::string_view(start, length);
+        fields.clear();
+        size_t fieldStart = 0;
+        for (size_t cut : cuts) {
+            fields.emplace_back(start + fieldStart, cut - fieldStart);
+            fieldStart = cut + 1;
+        }
+        fields.emplace_back(start + fieldStart, length - fieldStart);
+
+        pos = hit == end ? end : hit + 1;
+        ++lineNumber;
+        return true;
+    }
+};
+
+template <typename Int>
+inline bool parseInt(std::string_view text, Int& value) {
+    const char* last = text.data() + text.size();
+    auto result = std::from_chars(text.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline bool parseFlag(std::string_view text, bool& value) {
+    if (text != "0" && text != "1") {
+        return false;
+    }
+    value = text == "1";
+    return true;
+}
+
+// Read-only view of a whole file. Uses mmap where available and falls back
+// to reading the file into memory elsewhere.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(buffer.data(), buffer.size());
+        data = buffer.data();
+        size = buffer.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                data = static_cast<const char*>(addr);
+                size = st.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return data != nullptr; }
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+// Unbuffered file helpers for durable writes (journal and saves)
+inline int openForAppend(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+inline bool writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1 << 30)));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+inline bool syncToDisk(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+inline bool truncateTo(int fd, uint64_t size) {
+#ifdef _WIN32
+    return _chsize_s(fd, static_cast<__int64>(size)) == 0;
+#else
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+inline void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Flushes a finished temporary file to disk and atomically moves it over
+// the target, so a crash leaves either the old or the new file.
+inline bool replaceFile(const std::string& temporary, const std::string& target) {
+    int fd = openForAppend(temporary);
+    bool synced = fd >= 0 && syncToDisk(fd);
+    if (fd >= 0) {
+        closeFile(fd);
+    }
+#ifdef _WIN32
+    std::remove(target.c_str());
+#endif
+    return synced && std::rename(temporary.c_str(), target.c_str()) == 0;
+}
+
+// Append-only log of Library mutations made since the last save. The file
+// starts with a magic and the generation of the save it extends; each
+// record is
+//   uint32 length | uint8 type | payload | uint32 checksum
+// where length and checksum cover type and payload. Concurrent commits are
+// batched (group commit): the first caller writes and fsyncs everything
+// appended so far while later callers wait for that flush. A failed flush
+// cuts the file back to its last durable length and leaves the journal
+// failed, refusing every later commit, until reset() starts a new one.
+class Journal {
+public:
+    enum RecordType : uint8_t { ADD_BOOK = 1, ADD_MEMBER = 2, ISSUE = 3, RETURN = 4, RENEW = 5 };
+
+    class Record {
+    private:
+        std::vector<char> bytes;
+
+    public:
+        explicit Record(RecordType type) {
+            bytes.reserve(64);
+            bytes.assign(sizeof(uint32_t), 0); // length, filled in by finish()
+            bytes.push_back(static_cast<char>(type));
+        }
+
+        Record& putInt(int32_t value) {
+            const char* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(value));
+            return *this;
+        }
+
+        Record& putInt64(int64_t value) {
+            const char* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(value));
+            return *this;
+        }
+
+        Record& putString(std::string_view text) {
+            putInt(static_cast<int32_t>(text.size()));
+            bytes.insert(bytes.end(), text.begin(), text.end());
+            return *this;
+        }
+
+        // Fills in the length prefix and checksum; returns the encoded record
+        const std::vector<char>& finish() {
+            uint32_t length = static_cast<uint32_t>(bytes.size() - sizeof(uint32_t));
+            std::memcpy(bytes.data(), &length, sizeof(length));
+            uint32_t checksum = static_cast<uint32_t>(snapshotChecksum(bytes.data() + sizeof(uint32_t), length));
+            const char* raw = reinterpret_cast<const char*>(&checksum);
+            bytes.insert(bytes.end(), raw, raw + sizeof(checksum));
+            return bytes;
+        }
+    };
+
+    class Cursor {
+    private:
+        const char* pos;
+        const char* end;
+
+    public:
+        Cursor(const char* data, size_t size) : pos(data), end(data + size) {}
+
+        bool getInt(int32_t& value) {
+            if (end - pos < static_cast<std::ptrdiff_t>(sizeof(value))) {
+                return false;
+            }
+            std::memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        }
+
+        bool getInt64(int64_t& value) {
+            if (end - pos < static_cast<std::ptrdiff_t>(sizeof(value))) {
+                return false;
+            }
+            std::memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        }
+
+        bool getString(std::string_view& text) {
+            int32_t length;
+            if (!getInt(length) || length < 0 || end - pos < length) {
+                return false;
+            }
+            text = std::string_view(pos, static_cast<size_t>(length));
+            pos += length;
+            return true;
+        }
+    };
+
+private:
+    static constexpr char MAGIC[8] = {'L', 'I', 'B', 'J', 'R', 'N', 'L', '\0'};
+    static const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint32_t);
+
+    std::string path;
+    int fd = -1;
+    uint32_t generation = 0;
+    std::atomic<size_t> recordCount{0};
+
+    std::mutex mutex;
+    std::condition_variable flushed;
+    std::vector<char> pending;
+    size_t pendingRecords = 0;
+    uint64_t appendedSeq = 0;
+    uint64_t durableSeq = 0;
+    uint64_t durableLength = 0; // bytes of the file known to be on disk
+    bool flushing = false;
+    std::atomic<bool> failed{false};
+
+    // Calls visit(type, payload, size) for each intact record and returns the
+    // byte length of the valid prefix; a torn or corrupt tail ends the scan.
+    template <typename Visit>
+    static size_t scan(const char* data, size_t size, Visit visit) {
+        size_t pos = HEADER_SIZE;
+        while (size - pos >= 2 * sizeof(uint32_t)) {
+            uint32_t length, checksum;
+            std::memcpy(&length, data + pos, sizeof(length));
+            if (length == 0 || size - pos - 2 * sizeof(uint32_t) < length) {
+                break;
+            }
+            const char* body = data + pos + sizeof(uint32_t);
+            std::memcpy(&checksum, body + length, sizeof(checksum));
+            if (static_cast<uint32_t>(snapshotChecksum(body, length)) != checksum) {
+                break;
+            }
+            visit(static_cast<uint8_t>(body[0]), body + 1, length - 1);
+            pos += length + 2 * sizeof(uint32_t);
+        }
+        return pos;
+    }
+
+    bool writeHeader() {
+        char header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        std::memcpy(header + sizeof(MAGIC), &generation, sizeof(generation));
+        return truncateTo(fd, 0) && writeFully(fd, header, sizeof(header)) && syncToDisk(fd);
+    }
+
+public:
+    // An empty path gives a journal that records nothing and whose commits
+    // succeed at once (see Library(false))
+    explicit Journal(std::string journalPath) : path(std::move(journalPath)) {
+        if (path.empty()) {
+            return;
+        }
+        size_t validLength = 0;
+        {
+            MappedFile existing(path);
+            if (existing.isOpen() && existing.getSize() >= HEADER_SIZE
+                && std::memcmp(existing.getData(), MAGIC, sizeof(MAGIC)) == 0) {
+                std::memcpy(&generation, existing.getData() + sizeof(MAGIC), sizeof(generation));
+                validLength = scan(existing.getData(), existing.getSize(),
+                                   [this](uint8_t, const char*, size_t) { ++recordCount; });
+                if (validLength < existing.getSize()) {
+                    std::cerr << "Warning: discarding a torn record at the end of " << path << ".\n";
+                }
+            }
+        }
+        fd = openForAppend(path);
+        if (fd < 0) {
+            std::cerr << "Warning: cannot open " << path << "; changes will not be journaled.\n";
+            return;
+        }
+        if (validLength == 0) {
+            failed = !writeHeader();
+            durableLength = HEADER_SIZE;
+        } else {
+            failed = !truncateTo(fd, validLength);
+            durableLength = validLength;
+        }
+    }
+
+    ~Journal() {
+        if (fd >= 0) {
+            closeFile(fd);
+        }
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    uint32_t getGeneration() const { return generation; }
+    size_t getRecordCount() const { return recordCount; }
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+    // Queues a record and returns its sequence number for commit(). Once
+    // the journal has failed the record is dropped and its commit fails.
+    uint64_t append(Record& record) {
+        if (fd < 0) {
+            return 0;
+        }
+        const std::vector<char>& bytes = record.finish();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed.load(std::memory_order_relaxed)) {
+            pending.insert(pending.end(), bytes.begin(), bytes.end());
+            ++pendingRecords;
+            ++recordCount;
+        }
+        return ++appendedSeq;
+    }
+
+    // Waits until the record with sequence number seq is on disk; false if
+    // it never will be because a flush failed
+    bool commit(uint64_t seq) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (durableSeq < seq && !failed.load(std::memory_order_relaxed)) {
+            if (flushing) {
+                flushed.wait(lock);
+                continue;
+            }
+            flushing = true;
+            std::vector<char> batch;
+            batch.swap(pending);
+            size_t batchRecords = pendingRecords;
+            pendingRecords = 0;
+            uint64_t batchSeq = appendedSeq;
+            lock.unlock();
+            bool ok = writeFully(fd, batch.data(), batch.size()) && syncToDisk(fd);
+            if (!ok) {
+                // A torn record would hide everything appended after it
+                truncateTo(fd, durableLength);
+            }
+            lock.lock();
+            if (ok) {
+                durableLength += batch.size();
+                durableSeq = std::max(durableSeq, batchSeq);
+            } else {
+                std::cerr << "Warning: failed to write " << path << "; changes are no longer journaled.\n";
+                recordCount -= batchRecords;
+                failed.store(true, std::memory_order_release);
+            }
+            flushing = false;
+            flushed.notify_all();
+        }
+        return durableSeq >= seq;
+    }
+
+    // Waits until everything appended so far is on disk; false if a flush failed
+    bool sync() {
+        uint64_t seq;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            seq = appendedSeq;
+        }
+        return commit(seq);
+    }
+
+    // Starts an empty journal on top of a new save. Anything still pending is
+    // already part of that save and is dropped. With keepOld the previous
+    // journal is first copied aside to <path>.old.
+    void reset(uint32_t newGeneration, bool keepOld = false) {
+        std::unique_lock<std::mutex> lock(mutex);
+        flushed.wait(lock, [this] { return !flushing; });
+        if (fd < 0) {
+            return;
+        }
+        if (keepOld && recordCount > 0) {
+            MappedFile old(path);
+            std::ofstream backup(path + ".old", std::ios::binary);
+            if (old.isOpen()) {
+                backup.write(old.getData(), old.getSize());
+            }
+        }
+        pending.clear();
+        pendingRecords = 0;
+        durableSeq = appendedSeq;
+        generation = newGeneration;
+        recordCount = 0;
+        if (writeHeader()) {
+            durableLength = HEADER_SIZE;
+            failed.store(false, std::memory_order_release);
+        } else {
+            std::cerr << "Warning: failed to reset " << path << ".\n";
+            failed.store(true, std::memory_order_release);
+        }
+        flushed.notify_all();
+    }
+
+    // Calls apply(type, Cursor) for every committed record, oldest first
+    template <typename Apply>
+    size_t replay(Apply apply) const {
+        MappedFile file(path);
+        if (!file.isOpen() || file.getSize() < HEADER_SIZE) {
+            return 0;
+        }
+        size_t applied = 0;
+        scan(file.getData(), file.getSize(), [&](uint8_t type, const char* payload, size_t size) {
+            apply(type, Cursor(payload, size));
+            ++applied;
+        });
+        return applied;
+    }
+};
+
 // Book class
 class Book {
 private:
@@ -24,240 +738,1674 @@ public:
     Book(int id, std::string t, std::string a) : bookID(id), title(t), author(a), isAvailable(true) {}
 
     int getID() const { return bookID; }
-    std::string getTitle() const { return title; }
-    std::string getAuthor() const { return author; }
+    std::string_view getTitle() const { return title; }
+    std::string_view getAuthor() const { return author; }
     bool getAvailability() const { return isAvailable; }
 
-    void setAvailability(bool status) { isAvailable = status; }
-    void display() const {
-        std::cout << "Book ID: " << bookID << "\nTitle: " << title << "\nAuthor: " << author 
-                  << "\nAvailable: " << (isAvailable ? "Yes" : "No") << std::endl;
+    void setAvailability(bool status) { isAvailable = status; }
+    void display() const {
+        std::cout << "Book ID: " << bookID << "\nTitle: " << title << "\nAuthor: " << author 
+                  << "\nAvailable: " << (isAvailable ? "Yes" : "No") << std::endl;
+    }
+};
+
+// Deduplicating string store: each distinct string is kept once in a shared
+// byte arena and referred to by a 32-bit handle. Views returned by get()
+// stay valid until the next intern().
+class StringPool {
+private:
+    std::vector<char> bytes;
+    std::vector<uint32_t> offsets{0}; // string h is bytes[offsets[h], offsets[h + 1])
+    std::vector<uint32_t> table;      // open addressing, stores handle + 1 (0 = empty)
+
+    static uint64_t hash(std::string_view text) {
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : text) {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    void rehash(size_t capacity) {
+        table.assign(capacity, 0);
+        for (uint32_t handle = 0; handle + 1 < offsets.size(); ++handle) {
+            size_t i = hash(get(handle)) & (capacity - 1);
+            while (table[i] != 0) {
+                i = (i + 1) & (capacity - 1);
+            }
+            table[i] = handle + 1;
+        }
+    }
+
+public:
+    uint32_t intern(std::string_view text) {
+        if ((count() + 1) * 2 > table.size()) {
+            rehash(std::max<size_t>(64, table.size() * 2));
+        }
+        size_t i = hash(text) & (table.size() - 1);
+        while (table[i] != 0) {
+            if (get(table[i] - 1) == text) {
+                return table[i] - 1;
+            }
+            i = (i + 1) & (table.size() - 1);
+        }
+        if (bytes.size() + text.size() > UINT32_MAX) {
+            throw std::length_error("String pool is full.");
+        }
+        uint32_t handle = static_cast<uint32_t>(count());
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        offsets.push_back(static_cast<uint32_t>(bytes.size()));
+        table[i] = handle + 1;
+        return handle;
+    }
+
+    std::string_view get(uint32_t handle) const {
+        return std::string_view(bytes.data() + offsets[handle], offsets[handle + 1] - offsets[handle]);
+    }
+
+    size_t count() const { return offsets.size() - 1; }
+
+    size_t memoryUsage() const {
+        return bytes.capacity() + offsets.capacity() * sizeof(uint32_t) + table.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Column store for the catalog, one row per book slot: an ID column, an
+// availability bitset and pooled title/author handles. Availability bits
+// are atomic so concurrent checkouts can claim books without a lock; rows
+// are only appended while no checkouts are running.
+class BookTable {
+private:
+    std::vector<int> ids;
+    std::vector<uint32_t> titles;
+    std::vector<uint32_t> authors;
+    std::vector<std::atomic<uint64_t>> available;
+    StringPool text;
+
+    void growBits(size_t words) {
+        if (words <= available.size()) {
+            return;
+        }
+        std::vector<std::atomic<uint64_t>> grown(std::max(words, available.size() * 2));
+        for (size_t i = 0; i < grown.size(); ++i) {
+            grown[i].store(i < available.size() ? available[i].load(std::memory_order_relaxed) : 0,
+                           std::memory_order_relaxed);
+        }
+        available.swap(grown);
+    }
+
+    static uint64_t bitFor(size_t slot) { return uint64_t(1) << (slot % 64); }
+
+public:
+    size_t size() const { return ids.size(); }
+
+    void reserve(size_t rows) {
+        ids.reserve(rows);
+        titles.reserve(rows);
+        authors.reserve(rows);
+        growBits((rows + 63) / 64);
+    }
+
+    size_t append(int id, std::string_view title, std::string_view author, bool isAvailable) {
+        size_t slot = ids.size();
+        ids.push_back(id);
+        titles.push_back(text.intern(title));
+        authors.push_back(text.intern(author));
+        growBits(slot / 64 + 1);
+        setAvailability(slot, isAvailable);
+        return slot;
+    }
+
+    int getID(size_t slot) const { return ids[slot]; }
+    std::string_view getTitle(size_t slot) const { return text.get(titles[slot]); }
+    std::string_view getAuthor(size_t slot) const { return text.get(authors[slot]); }
+    bool getAvailability(size_t slot) const {
+        return (available[slot / 64].load(std::memory_order_acquire) & bitFor(slot)) != 0;
+    }
+
+    void setAvailability(size_t slot, bool status) {
+        if (status) {
+            available[slot / 64].fetch_or(bitFor(slot), std::memory_order_release);
+        } else {
+            available[slot / 64].fetch_and(~bitFor(slot), std::memory_order_acq_rel);
+        }
+    }
+
+    // Atomically marks an available book as out. Returns false if it was
+    // already unavailable.
+    bool claim(size_t slot) {
+        return (available[slot / 64].fetch_and(~bitFor(slot), std::memory_order_acq_rel) & bitFor(slot)) != 0;
+    }
+
+    Book getBook(size_t slot) const {
+        Book book(ids[slot], std::string(getTitle(slot)), std::string(getAuthor(slot)));
+        book.setAvailability(getAvailability(slot));
+        return book;
+    }
+
+    size_t memoryUsage() const {
+        return ids.capacity() * sizeof(int) + (titles.capacity() + authors.capacity()) * sizeof(uint32_t)
+               + available.capacity() * sizeof(uint64_t) + text.memoryUsage();
+    }
+};
+
+// Member class
+class Member {
+private:
+    int memberID;
+    std::string name;
+
+public:
+    Member(int id, std::string n) : memberID(id), name(n) {}
+
+    int getID() const { return memberID; }
+    std::string getName() const { return name; }
+
+    void display() const {
+        std::cout << "Member ID: " << memberID << "\nName: " << name << std::endl;
+    }
+};
+
+inline std::string formatDate(int64_t timestamp) {
+    if (timestamp == 0) {
+        return "-";
+    }
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", std::localtime(&time));
+    return buffer;
+}
+
+// Loan class
+class Loan {
+private:
+    int bookID;
+    int memberID;
+    bool isActive;
+    int64_t issueDate; // Unix seconds; 0 for loans recorded before due dates existed
+    int64_t dueDate;
+
+public:
+    Loan(int bID, int mID, int64_t issued = 0, int64_t due = 0)
+        : bookID(bID), memberID(mID), isActive(true), issueDate(issued), dueDate(due) {}
+
+    int getBookID() const { return bookID; }
+    int getMemberID() const { return memberID; }
+    bool getStatus() const { return isActive; }
+    int64_t getIssueDate() const { return issueDate; }
+    int64_t getDueDate() const { return dueDate; }
+
+    void closeLoan() { isActive = false; }
+    void setDueDate(int64_t due) { dueDate = due; }
+
+    void display() const {
+        std::cout << "Book ID: " << bookID << "\nMember ID: " << memberID 
+                  << "\nIssued: " << formatDate(issueDate) << "\nDue: " << formatDate(dueDate)
+                  << "\nActive: " << (isActive ? "Yes" : "No") << std::endl;
+    }
+};
+
+// Tokenized, case-folded inverted index over book titles and authors.
+// Posting lists hold book slots (positions in Library::books) in ascending
+// order; slots only ever grow, so appends keep every list sorted.
+class SearchIndex {
+private:
+    // Ordered by term so a prefix query is a contiguous range
+    std::map<std::string, std::vector<uint32_t>> postings;
+
+    // Calls emit(token) for each run of letters/digits, lower-cased.
+    // Bytes >= 0x80 count as letters so UTF-8 words stay intact.
+    template <typename Emit>
+    static void tokenize(std::string_view text, Emit emit) {
+        std::string token;
+        for (size_t i = 0; i <= text.size(); ++i) {
+            unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+            if (std::isalnum(c) || c >= 0x80) {
+                token.push_back(static_cast<char>(std::tolower(c)));
+            } else if (!token.empty()) {
+                emit(token);
+                token.clear();
+            }
+        }
+    }
+
+    template <typename Map>
+    static void addText(Map& map, uint32_t slot, std::string_view text) {
+        tokenize(text, [&map, slot](const std::string& token) {
+            auto& list = map[token];
+            if (list.empty() || list.back() != slot) {
+                list.push_back(slot);
+            }
+        });
+    }
+
+    // First index >= from in list whose value is >= target (exponential search)
+    static size_t gallop(const std::vector<uint32_t>& list, size_t from, uint32_t target) {
+        size_t step = 1;
+        size_t hi = from;
+        while (hi < list.size() && list[hi] < target) {
+            from = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        return std::lower_bound(list.begin() + from, list.begin() + std::min(hi, list.size()), target)
+               - list.begin();
+    }
+
+    static std::vector<uint32_t> intersect(const std::vector<uint32_t>& small, const std::vector<uint32_t>& large) {
+        std::vector<uint32_t> result;
+        size_t pos = 0;
+        for (uint32_t slot : small) {
+            pos = gallop(large, pos, slot);
+            if (pos == large.size()) {
+                break;
+            }
+            if (large[pos] == slot) {
+                result.push_back(slot);
+            }
+        }
+        return result;
+    }
+
+    // Posting list for one query term; "term*" unions every term with that prefix
+    std::vector<uint32_t> lookup(const std::string& term) const {
+        if (term.size() > 1 && term.back() == '*') {
+            std::string prefix = term.substr(0, term.size() - 1);
+            std::vector<uint32_t> merged;
+            for (auto it = postings.lower_bound(prefix);
+                 it != postings.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+                merged.insert(merged.end(), it->second.begin(), it->second.end());
+            }
+            std::sort(merged.begin(), merged.end());
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+            return merged;
+        }
+        auto it = postings.find(term);
+        return it == postings.end() ? std::vector<uint32_t>() : it->second;
+    }
+
+public:
+    void add(uint32_t slot, std::string_view title, std::string_view author) {
+        addText(postings, slot, title);
+        addText(postings, slot, author);
+    }
+
+    // Indexes slots [begin, end), all greater than any slot already indexed.
+    // textOf(slot) returns the (title, author) pair. Large ranges are split
+    // across threads and merged in slot order.
+    template <typename TextOf>
+    void addRange(uint32_t begin, uint32_t end, TextOf textOf) {
+        const uint32_t minSlotsPerThread = 1 << 16;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<unsigned>(threads, (end - begin) / minSlotsPerThread + 1);
+
+        std::vector<std::unordered_map<std::string, std::vector<uint32_t>>> partial(threads);
+        auto build = [&](unsigned part) {
+            uint32_t from = begin + static_cast<uint32_t>(uint64_t(end - begin) * part / threads);
+            uint32_t to = begin + static_cast<uint32_t>(uint64_t(end - begin) * (part + 1) / threads);
+            for (uint32_t slot = from; slot < to; ++slot) {
+                auto text = textOf(slot);
+                addText(partial[part], slot, text.first);
+                addText(partial[part], slot, text.second);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned part = 1; part < threads; ++part) {
+            workers.emplace_back(build, part);
+        }
+        build(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (auto& map : partial) {
+            for (auto& entry : map) {
+                auto& list = postings[entry.first];
+                list.insert(list.end(), entry.second.begin(), entry.second.end());
+            }
+        }
+    }
+
+    // Slots matching every term of the query, ascending
+    std::vector<uint32_t> search(std::string_view query) const {
+        std::vector<std::string> terms;
+        std::string word;
+        for (size_t i = 0; i <= query.size(); ++i) {
+            if (i == query.size() || std::isspace(static_cast<unsigned char>(query[i]))) {
+                if (!word.empty()) {
+                    bool prefix = word.back() == '*';
+                    tokenize(word, [&terms](const std::string& token) { terms.push_back(token); });
+                    if (prefix && !terms.empty()) {
+                        terms.back() += '*';
+                    }
+                    word.clear();
+                }
+            } else {
+                word.push_back(query[i]);
+            }
+        }
+        if (terms.empty()) {
+            return {};
+        }
+
+        std::vector<std::vector<uint32_t>> lists;
+        for (const auto& term : terms) {
+            lists.push_back(lookup(term));
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const auto& a, const auto& b) { return a.size() < b.size(); });
+        std::vector<uint32_t> result = std::move(lists[0]);
+        for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+            result = intersect(result, lists[i]);
+        }
+        return result;
+    }
+};
+
+// "Members who borrowed this also borrowed": for every book slot, the books
+// most often borrowed by the same members, strongest first. Built offline
+// from the loan history and stored as CSR (the neighbours of slot s are
+// neighbors[offsets[s] .. offsets[s + 1])), so a lookup is two array reads.
+class CoBorrowIndex {
+public:
+    struct Neighbor {
+        uint32_t slot;
+        uint32_t count; // members who borrowed both books
+    };
+
+private:
+    std::vector<size_t> offsets;
+    std::vector<Neighbor> neighbors;
+
+    // Rows of a CSR built from `starts` (row sizes, turned into offsets)
+    static void toOffsets(std::vector<size_t>& starts) {
+        size_t total = 0;
+        for (auto& start : starts) {
+            size_t size = start;
+            start = total;
+            total += size;
+        }
+    }
+
+public:
+    // loans holds (member, book slot) pairs; repeated pairs count once.
+    // Members with more than maxBasket distinct books are left out: their
+    // cost is quadratic in basket size and they say little about any book.
+    void build(std::vector<std::pair<uint32_t, uint32_t>> loans, uint32_t memberCount, uint32_t bookCount,
+               size_t topK, size_t maxBasket = 500) {
+        // Group book slots by member (counting sort), then dedupe each basket
+        std::vector<size_t> basketStart(size_t(memberCount) + 1, 0);
+        for (const auto& loan : loans) {
+            ++basketStart[loan.first];
+        }
+        toOffsets(basketStart);
+        std::vector<uint32_t> basketBooks(loans.size());
+        {
+            std::vector<size_t> next(basketStart.begin(), basketStart.end() - 1);
+            for (const auto& loan : loans) {
+                basketBooks[next[loan.first]++] = loan.second;
+            }
+        }
+        std::vector<std::pair<uint32_t, uint32_t>>().swap(loans);
+
+        size_t kept = 0;
+        for (uint32_t member = 0; member < memberCount; ++member) {
+            auto first = basketBooks.begin() + basketStart[member];
+            auto last = basketBooks.begin() + basketStart[member + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+            size_t size = last - first;
+            basketStart[member] = kept;
+            if (size >= 2 && size <= maxBasket) {
+                kept = std::copy(first, last, basketBooks.begin() + kept) - basketBooks.begin();
+            }
+        }
+        basketStart[memberCount] = kept;
+        basketBooks.resize(kept);
+        basketBooks.shrink_to_fit();
+
+        // Invert to book slot -> members who borrowed it
+        std::vector<size_t> readerStart(size_t(bookCount) + 1, 0);
+        for (uint32_t slot : basketBooks) {
+            ++readerStart[slot];
+        }
+        toOffsets(readerStart);
+        std::vector<uint32_t> readers(basketBooks.size());
+        {
+            std::vector<size_t> next(readerStart.begin(), readerStart.end() - 1);
+            for (uint32_t member = 0; member < memberCount; ++member) {
+                for (size_t i = basketStart[member]; i < basketStart[member + 1]; ++i) {
+                    readers[next[basketBooks[i]]++] = member;
+                }
+            }
+        }
+
+        // Count co-borrowers one source book at a time into a dense scratch
+        // array, keeping the top K. Source books are handed out in chunks so
+        // no merge is needed: chunk results concatenate into the CSR.
+        const uint32_t chunkSize = 4096;
+        size_t chunkCount = (size_t(bookCount) + chunkSize - 1) / chunkSize;
+        struct Chunk {
+            std::vector<Neighbor> neighbors;
+            std::vector<size_t> sizes;
+        };
+        std::vector<Chunk> chunks(chunkCount);
+        std::atomic<size_t> nextChunk{0};
+        auto work = [&]() {
+            std::vector<uint32_t> together(bookCount, 0);
+            std::vector<uint32_t> touched;
+            for (size_t c = nextChunk++; c < chunkCount; c = nextChunk++) {
+                Chunk& chunk = chunks[c];
+                uint32_t from = static_cast<uint32_t>(c * chunkSize);
+                uint32_t to = static_cast<uint32_t>(std::min<size_t>(bookCount, from + size_t(chunkSize)));
+                for (uint32_t source = from; source < to; ++source) {
+                    touched.clear();
+                    for (size_t r = readerStart[source]; r < readerStart[source + 1]; ++r) {
+                        uint32_t member = readers[r];
+                        for (size_t i = basketStart[member]; i < basketStart[member + 1]; ++i) {
+                            uint32_t other = basketBooks[i];
+                            if (other != source && together[other]++ == 0) {
+                                touched.push_back(other);
+                            }
+                        }
+                    }
+                    size_t keep = std::min(topK, touched.size());
+                    std::partial_sort(touched.begin(), touched.begin() + keep, touched.end(),
+                                      [&together](uint32_t a, uint32_t b) {
+                                          return together[a] != together[b] ? together[a] > together[b] : a < b;
+                                      });
+                    for (size_t i = 0; i < keep; ++i) {
+                        chunk.neighbors.push_back({touched[i], together[touched[i]]});
+                    }
+                    chunk.sizes.push_back(keep);
+                    for (uint32_t other : touched) {
+                        together[other] = 0;
+                    }
+                }
+            }
+        };
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<size_t>(threads, chunkCount));
+        std::vector<std::thread> workers;
+        for (unsigned part = 1; part < threads; ++part) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        offsets.assign(1, 0);
+        offsets.reserve(size_t(bookCount) + 1);
+        neighbors.clear();
+        for (auto& chunk : chunks) {
+            for (size_t size : chunk.sizes) {
+                offsets.push_back(offsets.back() + size);
+            }
+            neighbors.insert(neighbors.end(), chunk.neighbors.begin(), chunk.neighbors.end());
+            std::vector<Neighbor>().swap(chunk.neighbors);
+        }
+        neighbors.shrink_to_fit();
+    }
+
+    // Neighbours of a slot, strongest first; empty for slots added since the build
+    std::pair<const Neighbor*, const Neighbor*> neighborsOf(uint32_t slot) const {
+        if (size_t(slot) + 1 >= offsets.size()) {
+            return {nullptr, nullptr};
+        }
+        return {neighbors.data() + offsets[slot], neighbors.data() + offsets[slot + 1]};
+    }
+
+    size_t memoryUsage() const { return offsets.capacity() * sizeof(size_t) + neighbors.capacity() * sizeof(Neighbor); }
+};
+
+// One page of search results
+struct SearchPage {
+    std::vector<Book> books;
+    size_t totalMatches = 0;
+};
+
+// Result of Library::getLoanSummary
+struct MemberLoanSummary {
+    size_t activeLoans = 0;
+    size_t overdueLoans = 0;
+    uint64_t totalBorrowed = 0; // every loan ever issued, returned or not
+};
+
+// Library class
+class Library {
+private:
+    BookTable books;
+    std::vector<Member> members;
+    // A book has at most one active loan, so active loans are keyed by book
+    // ID and spread over lock stripes so checkouts of different books run in
+    // parallel. Returned loans are appended to loanHistory and never
+    // revisited by issueBook/returnBook.
+    struct alignas(64) LoanStripe {
+        mutable std::mutex mutex;
+        std::unordered_map<int, Loan> active;
+    };
+    static const size_t LOAN_STRIPES = 64;
+    std::array<LoanStripe, LOAN_STRIPES> loanStripes;
+    std::mutex historyMutex;
+    std::vector<Loan> loanHistory;
+
+    // Active loans ordered by (due date, book ID), so due-date queries cost
+    // O(log n + results) however long the history is. Lock order:
+    // catalogMutex, then a stripe, then dueMutex.
+    std::set<std::pair<int64_t, int>> dueIndex;
+    mutable std::mutex dueMutex;
+
+    // Per-member loan aggregates, kept up to date by every issue/return so
+    // limit checks and per-member queries cost O(that member's loans). Each
+    // member's active loans form a doubly linked list threaded through
+    // loanLinks, which is indexed by book slot since a book has at most one
+    // active loan. Both are guarded by the member's stripe; lock order:
+    // catalogMutex, member stripe, loan stripe, dueMutex.
+    static const uint32_t NO_LINK = static_cast<uint32_t>(-1);
+    struct MemberLoans {
+        uint32_t activeLoans = 0;
+        uint32_t firstSlot = NO_LINK;
+        uint64_t totalBorrowed = 0;
+    };
+    struct LoanLink {
+        uint32_t prev = NO_LINK;
+        uint32_t next = NO_LINK;
+        int64_t dueDate = 0;
+    };
+    std::vector<MemberLoans> memberLoans; // parallel to members
+    std::vector<LoanLink> loanLinks;      // parallel to books
+    struct alignas(64) MemberStripe {
+        mutable std::mutex mutex;
+    };
+    static const size_t MEMBER_STRIPES = 64;
+    std::array<MemberStripe, MEMBER_STRIPES> memberStripes;
+    int maxActiveLoans = MAX_ACTIVE_LOANS;
+    int maxOverdueLoans = MAX_OVERDUE_LOANS;
+
+    // issueBook/returnBook/searchBooks hold this shared; everything that adds
+    // records or walks every loan holds it exclusively.
+    mutable std::shared_mutex catalogMutex;
+
+    // ID -> position in books/members. Duplicate IDs keep the first entry,
+    // matching the order a linear scan would have found them in.
+    std::unordered_map<int, size_t> bookIndex;
+    std::unordered_map<int, size_t> memberIndex;
+
+    SearchIndex searchIndex;
+    CoBorrowIndex coBorrowIndex; // as of the last rebuildRecommendations
+
+    // Every mutation is journaled before it is acknowledged. generation
+    // identifies the last save; the journal only extends a save with the
+    // same generation. Checkpoints reuse the format of the last save/load.
+    Journal journal{LIBRARY_JOURNAL_FILE};
+    uint32_t generation = 0;
+    DataFormat lastFormat = DataFormat::Text;
+
+    // The journal on disk extends whatever an earlier session loaded or
+    // saved, not this library, until loadData or saveData ties them
+    // together; see attachJournal
+    std::atomic<bool> journalAttached{false};
+    std::mutex attachMutex;
+
+    // With deferCommits set (batch mode), changes are acknowledged without
+    // waiting for the disk and syncJournal makes them durable in bulk
+    bool deferCommits = false;
+
+    // When false, successful operations are silent (used by batch mode)
+    bool verbose = true;
+
+    void indexBook(size_t pos) { bookIndex.emplace(books.getID(pos), pos); }
+    void indexMember(size_t pos) { memberIndex.emplace(members[pos].getID(), pos); }
+
+    static const size_t NO_SLOT = static_cast<size_t>(-1);
+
+    size_t findBook(int bookID) const {
+        auto it = bookIndex.find(bookID);
+        return it == bookIndex.end() ? NO_SLOT : it->second;
+    }
+
+    LoanStripe& stripeFor(int bookID) { return loanStripes[static_cast<uint32_t>(bookID) % LOAN_STRIPES]; }
+
+    std::mutex& memberLockFor(int memberID) const {
+        return memberStripes[static_cast<uint32_t>(memberID) % MEMBER_STRIPES].mutex;
+    }
+
+    MemberLoans* findMemberLoans(int memberID) {
+        auto it = memberIndex.find(memberID);
+        return it == memberIndex.end() ? nullptr : &memberLoans[it->second];
+    }
+
+    // Stops counting once the count passes `stopAfter`
+    size_t countOverdue(const MemberLoans& aggregate, int64_t asOf, size_t stopAfter) const {
+        size_t count = 0;
+        for (uint32_t slot = aggregate.firstSlot; slot != NO_LINK && count <= stopAfter; slot = loanLinks[slot].next) {
+            int64_t due = loanLinks[slot].dueDate;
+            if (due != 0 && due < asOf) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // Member-side bookkeeping for a loan becoming active/closed. The caller
+    // holds the member's stripe (or catalogMutex exclusively).
+    void attachToMember(const Loan& loan) {
+        MemberLoans* aggregate = findMemberLoans(loan.getMemberID());
+        if (aggregate == nullptr) {
+            return;
+        }
+        ++aggregate->totalBorrowed;
+        if (!loan.getStatus()) {
+            return;
+        }
+        ++aggregate->activeLoans;
+        size_t slot = findBook(loan.getBookID());
+        if (slot == NO_SLOT) {
+            return;
+        }
+        LoanLink& link = loanLinks[slot];
+        link.prev = NO_LINK;
+        link.next = aggregate->firstSlot;
+        link.dueDate = loan.getDueDate();
+        if (aggregate->firstSlot != NO_LINK) {
+            loanLinks[aggregate->firstSlot].prev = static_cast<uint32_t>(slot);
+        }
+        aggregate->firstSlot = static_cast<uint32_t>(slot);
+    }
+
+    void detachFromMember(const Loan& loan) {
+        MemberLoans* aggregate = findMemberLoans(loan.getMemberID());
+        if (aggregate == nullptr) {
+            return;
+        }
+        --aggregate->activeLoans;
+        size_t slot = findBook(loan.getBookID());
+        if (slot == NO_SLOT) {
+            return;
+        }
+        LoanLink& link = loanLinks[slot];
+        if (link.prev != NO_LINK) {
+            loanLinks[link.prev].next = link.next;
+        } else {
+            aggregate->firstSlot = link.next;
+        }
+        if (link.next != NO_LINK) {
+            loanLinks[link.next].prev = link.prev;
+        }
+        link = LoanLink();
+    }
+
+    void setMemberDueDate(const Loan& loan) {
+        size_t slot = findBook(loan.getBookID());
+        if (slot != NO_SLOT) {
+            loanLinks[slot].dueDate = loan.getDueDate();
+        }
+    }
+
+    // Callers must hold catalogMutex exclusively
+    template <typename Visit>
+    void forEachActiveLoan(Visit visit) const {
+        for (const auto& stripe : loanStripes) {
+            for (const auto& entry : stripe.active) {
+                visit(entry.second);
+            }
+        }
+    }
+
+    size_t activeLoanCount() const {
+        size_t count = 0;
+        for (const auto& stripe : loanStripes) {
+            count += stripe.active.size();
+        }
+        return count;
+    }
+
+    bool isEmpty() const {
+        return books.size() == 0 && members.empty() && loanHistory.empty() && activeLoanCount() == 0;
+    }
+
+    static uint32_t newGeneration() {
+        std::random_device random;
+        uint32_t value = random() ^ static_cast<uint32_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        return value == 0 ? 1 : value;
+    }
+
+    // Record insertion shared by the interactive API and the loaders. The
+    // loaders skip the text index and call indexTextFrom once at the end.
+    void storeBook(int bookID, std::string_view title, std::string_view author, bool isAvailable,
+                   bool indexText = true) {
+        size_t slot = books.append(bookID, title, author, isAvailable);
+        loanLinks.emplace_back();
+        indexBook(slot);
+        if (indexText) {
+            searchIndex.add(static_cast<uint32_t>(slot), title, author);
+        }
+    }
+
+    void indexTextFrom(size_t firstSlot) {
+        searchIndex.addRange(static_cast<uint32_t>(firstSlot), static_cast<uint32_t>(books.size()),
+                             [this](uint32_t slot) {
+                                 return std::make_pair(books.getTitle(slot), books.getAuthor(slot));
+                             });
+    }
+
+    void storeMember(const Member& member) {
+        members.push_back(member);
+        memberLoans.emplace_back();
+        indexMember(members.size() - 1);
+    }
+
+    void indexDue(const Loan& loan) {
+        if (loan.getDueDate() != 0) {
+            std::lock_guard<std::mutex> lock(dueMutex);
+            dueIndex.emplace(loan.getDueDate(), loan.getBookID());
+        }
+    }
+
+    void unindexDue(const Loan& loan) {
+        std::lock_guard<std::mutex> lock(dueMutex);
+        dueIndex.erase({loan.getDueDate(), loan.getBookID()});
+    }
+
+    void storeLoan(const Loan& loan) {
+        if (!loan.getStatus()) {
+            loanHistory.push_back(loan);
+            attachToMember(loan);
+        } else if (stripeFor(loan.getBookID()).active.emplace(loan.getBookID(), loan).second) {
+            indexDue(loan);
+            attachToMember(loan);
+        } else {
+            std::cerr << "Warning: book " << loan.getBookID() << " has more than one active loan; keeping the first.\n";
+        }
+    }
+
+    bool saveSnapshot(uint32_t saveGeneration) const {
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.generation = saveGeneration;
+        header.bookCount = books.size();
+        header.memberCount = members.size();
+        header.loanCount = loanHistory.size() + activeLoanCount();
+        for (size_t slot = 0; slot < books.size(); ++slot) {
+            header.heapSize += books.getTitle(slot).size() + books.getAuthor(slot).size();
+        }
+        for (const auto& member : members) {
+            header.heapSize += member.getName().size();
+        }
+        if (header.heapSize > UINT32_MAX) {
+            std::cerr << "Error: catalog text is too large for the snapshot format.\n";
+            return false;
+        }
+
+        SnapshotLayout layout(header);
+        std::vector<char> image(layout.end);
+        char* base = image.data();
+        uint32_t heapUsed = 0;
+        auto putString = [&](size_t column, size_t row, std::string_view text) {
+            StringRef ref{heapUsed, static_cast<uint32_t>(text.size())};
+            std::memcpy(base + column + row * sizeof(StringRef), &ref, sizeof(ref));
+            std::memcpy(base + layout.heap + heapUsed, text.data(), text.size());
+            heapUsed += ref.length;
+        };
+        auto putInt = [&](size_t column, size_t row, int32_t value) {
+            std::memcpy(base + column + row * sizeof(int32_t), &value, sizeof(value));
+        };
+        auto putInt64 = [&](size_t column, size_t row, int64_t value) {
+            std::memcpy(base + column + row * sizeof(int64_t), &value, sizeof(value));
+        };
+
+        for (size_t i = 0; i < books.size(); ++i) {
+            putInt(layout.bookIDs, i, books.getID(i));
+            putString(layout.bookTitles, i, books.getTitle(i));
+            putString(layout.bookAuthors, i, books.getAuthor(i));
+            base[layout.bookAvailable + i] = books.getAvailability(i) ? 1 : 0;
+        }
+        for (size_t i = 0; i < members.size(); ++i) {
+            putInt(layout.memberIDs, i, members[i].getID());
+            putString(layout.memberNames, i, members[i].getName());
+        }
+        size_t row = 0;
+        auto putLoan = [&](const Loan& loan) {
+            putInt(layout.loanBookIDs, row, loan.getBookID());
+            putInt(layout.loanMemberIDs, row, loan.getMemberID());
+            putInt64(layout.loanIssued, row, loan.getIssueDate());
+            putInt64(layout.loanDue, row, loan.getDueDate());
+            base[layout.loanActive + row] = loan.getStatus() ? 1 : 0;
+            ++row;
+        };
+        for (const auto& loan : loanHistory) {
+            putLoan(loan);
+        }
+        forEachActiveLoan(putLoan);
+
+        header.checksum = snapshotChecksum(base + sizeof(header), image.size() - sizeof(header));
+        std::memcpy(base, &header, sizeof(header));
+
+        std::string temporary = LIBRARY_SNAPSHOT_FILE + ".tmp";
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error opening file for saving data.\n";
+            return false;
+        }
+        file.write(base, image.size());
+        file.close();
+        if (!file || !replaceFile(temporary, LIBRARY_SNAPSHOT_FILE)) {
+            std::cerr << "Error writing snapshot.\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool loadSnapshot(uint32_t& loadedGeneration) {
+        MappedFile map(LIBRARY_SNAPSHOT_FILE);
+        if (!map.isOpen()) {
+            std::cerr << "Error opening file for loading data.\n";
+            return false;
+        }
+
+        SnapshotHeader header;
+        if (map.getSize() < sizeof(header)) {
+            std::cerr << "Error: snapshot is truncated.\n";
+            return false;
+        }
+        std::memcpy(&header, map.getData(), sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+            std::cerr << "Error: " << LIBRARY_SNAPSHOT_FILE << " is not a library snapshot.\n";
+            return false;
+        }
+        if (header.version < 1 || header.version > SNAPSHOT_VERSION) {
+            std::cerr << "Error: unsupported snapshot version " << header.version << ".\n";
+            return false;
+        }
+        // Every record takes at least a byte, so larger counts cannot match
+        // the file size; rejecting them first keeps the layout from overflowing
+        if (header.bookCount > map.getSize() || header.memberCount > map.getSize()
+            || header.loanCount > map.getSize() || header.heapSize > map.getSize()) {
+            std::cerr << "Error: snapshot is truncated.\n";
+            return false;
+        }
+        SnapshotLayout layout(header);
+        if (layout.end != map.getSize()) {
+            std::cerr << "Error: snapshot is truncated.\n";
+            return false;
+        }
+        const char* base = map.getData();
+        if (snapshotChecksum(base + sizeof(header), map.getSize() - sizeof(header)) != header.checksum) {
+            std::cerr << "Error: snapshot checksum mismatch.\n";
+            return false;
+        }
+
+        // Columns are 4-byte aligned within a page-aligned mapping
+        auto ints = [base](size_t column) { return reinterpret_cast<const int32_t*>(base + column); };
+        auto refs = [base](size_t column) { return reinterpret_cast<const StringRef*>(base + column); };
+        const char* heap = base + layout.heap;
+        auto text = [heap](const StringRef& ref) { return std::string_view(heap + ref.offset, ref.length); };
+
+        // The checksum only catches accidental damage, so check that every
+        // string lies inside the heap before reading any of them
+        const int32_t* bookIDs = ints(layout.bookIDs);
+        const StringRef* titles = refs(layout.bookTitles);
+        const StringRef* authors = refs(layout.bookAuthors);
+        const StringRef* names = refs(layout.memberNames);
+        auto inHeap = [&header](const StringRef* column, uint64_t count) {
+            for (uint64_t i = 0; i < count; ++i) {
+                if (uint64_t(column[i].offset) + column[i].length > header.heapSize) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!inHeap(titles, header.bookCount) || !inHeap(authors, header.bookCount)
+            || !inHeap(names, header.memberCount)) {
+            std::cerr << "Error: snapshot string reference is out of range.\n";
+            return false;
+        }
+
+        // The columns are read in place, but strings are copied into the
+        // catalog's pool and members, which outlive the mapping
+        loadedGeneration = header.generation;
+        books.reserve(books.size() + header.bookCount);
+        for (size_t i = 0; i < header.bookCount; ++i) {
+            storeBook(bookIDs[i], text(titles[i]), text(authors[i]), base[layout.bookAvailable + i] != 0, false);
+        }
+
+        const int32_t* memberIDs = ints(layout.memberIDs);
+        members.reserve(members.size() + header.memberCount);
+        for (size_t i = 0; i < header.memberCount; ++i) {
+            storeMember(Member(memberIDs[i], std::string(text(names[i]))));
+        }
+
+        const int32_t* loanBookIDs = ints(layout.loanBookIDs);
+        const int32_t* loanMemberIDs = ints(layout.loanMemberIDs);
+        auto date = [&](size_t column, size_t row) {
+            int64_t value = 0;
+            if (header.version >= 2) {
+                std::memcpy(&value, base + column + row * sizeof(int64_t), sizeof(value));
+            }
+            return value;
+        };
+        for (size_t i = 0; i < header.loanCount; ++i) {
+            Loan loan(loanBookIDs[i], loanMemberIDs[i], date(layout.loanIssued, i), date(layout.loanDue, i));
+            if (base[layout.loanActive + i] == 0) {
+                loan.closeLoan();
+            }
+            storeLoan(loan);
+        }
+        return true;
+    }
+
+    bool saveText(uint32_t saveGeneration) const {
+        std::string temporary = LIBRARY_DATA_FILE + ".tmp";
+        std::ofstream file(temporary);
+        if (!file) {
+            std::cerr << "Error opening file for saving data.\n";
+            return false;
+        }
+
+        file << "Generation:" << saveGeneration << "\n";
+
+        // Save books
+        file << "Books:\n";
+        for (size_t slot = 0; slot < books.size(); ++slot) {
+            file << books.getID(slot) << "|" << books.getTitle(slot) << "|" << books.getAuthor(slot) 
+                 << "|" << (books.getAvailability(slot) ? "1" : "0") << "\n";
+        }
+
+        // Save members
+        file << "Members:\n";
+        for (const auto& member : members) {
+            file << member.getID() << "|" << member.getName() << "\n";
+        }
+
+        // Save loans: closed history first, then the ones still out
+        file << "Loans:\n";
+        auto saveLoan = [&file](const Loan& loan) {
+            file << loan.getBookID() << "|" << loan.getMemberID() 
+                 << "|" << (loan.getStatus() ? "1" : "0")
+                 << "|" << loan.getIssueDate() << "|" << loan.getDueDate() << "\n";
+        };
+        for (const auto& loan : loanHistory) {
+            saveLoan(loan);
+        }
+        forEachActiveLoan(saveLoan);
+
+        file.close();
+        if (!file || !replaceFile(temporary, LIBRARY_DATA_FILE)) {
+            std::cerr << "Error writing data file.\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool loadText(uint32_t& loadedGeneration) {
+        DelimitedReader reader(LIBRARY_DATA_FILE);
+        if (!reader.isOpen()) {
+            std::cerr << "Error opening file for loading data.\n";
+            return false;
+        }
+
+        enum Section { NONE, BOOKS, MEMBERS, LOANS };
+        Section currentSection = NONE;
+        size_t skipped = 0;
+        auto malformed = [&](const char* record) {
+            std::cerr << "Warning: " << LIBRARY_DATA_FILE << ":" << reader.getLineNumber()
+                      << ": malformed " << record << " line skipped.\n";
+            ++skipped;
+        };
+
+        loadedGeneration = 0;
+        while (reader.next()) {
+            std::string_view line = reader.getLine();
+            if (line == "Books:") {
+                currentSection = BOOKS;
+                continue;
+            } else if (line == "Members:") {
+                currentSection = MEMBERS;
+                continue;
+            } else if (line == "Loans:") {
+                currentSection = LOANS;
+                continue;
+            } else if (line.empty()) {
+                continue;
+            }
+
+            const auto& fields = reader.getFields();
+            if (currentSection == NONE && line.compare(0, 11, "Generation:") == 0) {
+                if (!parseInt(line.substr(11), loadedGeneration)) {
+                    malformed("generation");
+                    continue;
+                }
+
+            } else if (currentSection == BOOKS) {
+                // Parse book data: id|title|author|available
+                int bookID;
+                bool isAvailable;
+                if (fields.size() != 4 || !parseInt(fields[0], bookID) || !parseFlag(fields[3], isAvailable)) {
+                    malformed("book");
+                    continue;
+                }
+
+                storeBook(bookID, fields[1], fields[2], isAvailable, false);
+
+            } else if (currentSection == MEMBERS) {
+                // Parse member data: id|name (the name runs to the end of the line)
+                int memberID;
+                if (fields.size() < 2 || !parseInt(fields[0], memberID)) {
+                    malformed("member");
+                    continue;
+                }
+
+                storeMember(Member(memberID, std::string(line.substr(fields[0].size() + 1))));
+
+            } else if (currentSection == LOANS) {
+                // Parse loan data: bookID|memberID|active[|issued|due]
+                int bookID, memberID;
+                bool isActive;
+                int64_t issued = 0, due = 0;
+                if ((fields.size() != 3 && fields.size() != 5) || !parseInt(fields[0], bookID)
+                    || !parseInt(fields[1], memberID) || !parseFlag(fields[2], isActive)
+                    || (fields.size() == 5 && (!parseInt(fields[3], issued) || !parseInt(fields[4], due)))) {
+                    malformed("loan");
+                    continue;
+                }
+
+                Loan loan(bookID, memberID, issued, due);
+                if (!isActive) {
+                    loan.closeLoan();
+                }
+                storeLoan(loan);
+
+            } else {
+                malformed("unsectioned");
+            }
+        }
+
+        if (verbose && skipped > 0) {
+            std::cout << skipped << " malformed line(s) skipped.\n";
+        }
+        return true;
+    }
+
+    // Re-applies one journaled mutation; catalogMutex is held exclusively
+    void applyRecord(uint8_t type, Journal::Cursor cursor) {
+        int32_t first, second;
+        int64_t issued, due;
+        std::string_view title, author;
+        switch (type) {
+        case Journal::ADD_BOOK:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getString(title) && cursor.getString(author)) {
+                storeBook(first, title, author, second != 0, false);
+            }
+            break;
+        case Journal::ADD_MEMBER:
+            if (cursor.getInt(first) && cursor.getString(title)) {
+                storeMember(Member(first, std::string(title)));
+            }
+            break;
+        case Journal::ISSUE:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getInt64(issued) && cursor.getInt64(due)) {
+                size_t slot = findBook(first);
+                if (slot != NO_SLOT) {
+                    books.setAvailability(slot, false);
+                }
+                storeLoan(Loan(first, second, issued, due));
+            }
+            break;
+        case Journal::RETURN:
+            if (cursor.getInt(first) && cursor.getInt(second)) {
+                auto& active = stripeFor(first).active;
+                auto it = active.find(first);
+                if (it != active.end() && it->second.getMemberID() == second) {
+                    unindexDue(it->second);
+                    detachFromMember(it->second);
+                    it->second.closeLoan();
+                    loanHistory.push_back(it->second);
+                    active.erase(it);
+                    size_t slot = findBook(first);
+                    if (slot != NO_SLOT) {
+                        books.setAvailability(slot, true);
+                    }
+                }
+            }
+            break;
+        case Journal::RENEW:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getInt64(due)) {
+                auto& active = stripeFor(first).active;
+                auto it = active.find(first);
+                if (it != active.end() && it->second.getMemberID() == second) {
+                    unindexDue(it->second);
+                    it->second.setDueDate(due);
+                    indexDue(it->second);
+                    setMemberDueDate(it->second);
+                }
+            }
+            break;
+        }
+    }
+
+    // Writes a full save under a new generation and starts a fresh journal;
+    // catalogMutex is held exclusively
+    bool saveLocked(DataFormat format) {
+        uint32_t next = newGeneration();
+        bool saved = format == DataFormat::Binary ? saveSnapshot(next) : saveText(next);
+        if (!saved) {
+            return false;
+        }
+        generation = next;
+        lastFormat = format;
+        journal.reset(next);
+        journalAttached.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Called before the first change of a library that has neither loaded
+    // nor saved. Appending to the old journal would make the next load
+    // replay this session's changes on top of a save they never saw, so it
+    // is moved to <journal>.old and an empty one extending an empty library
+    // (generation 0) is started instead.
+    void attachJournal() {
+        if (journalAttached.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(attachMutex);
+        if (journalAttached.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (journal.getRecordCount() > 0) {
+            std::cerr << "Warning: " << LIBRARY_JOURNAL_FILE << " was not loaded; moved it to "
+                      << LIBRARY_JOURNAL_FILE << ".old before recording new changes.\n";
+        }
+        if (journal.getRecordCount() > 0 || journal.getGeneration() != 0) {
+            journal.reset(0, true);
+        }
+        journalAttached.store(true, std::memory_order_release);
+    }
+
+    uint64_t appendToJournal(Journal::Record& record) {
+        attachJournal();
+        return journal.append(record);
+    }
+
+    // False if the change could not be made durable. It stays in memory,
+    // but nothing more is accepted (NotJournaled) until a save succeeds.
+    bool commitChange(uint64_t seq) {
+        return deferCommits || journal.commit(seq);
+    }
+
+    // Bounds journal size (and recovery time) by saving once it grows large
+    void checkpointIfDue() {
+        if (journal.getRecordCount() < JOURNAL_CHECKPOINT_RECORDS) {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        if (journal.getRecordCount() >= JOURNAL_CHECKPOINT_RECORDS) {
+            saveLocked(lastFormat);
+        }
     }
-};
 
-// Member class
-class Member {
-private:
-    int memberID;
-    std::string name;
+    // Core of issue/return. catalogMutex must be held (shared is enough);
+    // on success seq is the journal record to commit.
+    LoanStatus issueLocked(int bookID, int memberID, uint64_t& seq) {
+        MemberLoans* aggregate = findMemberLoans(memberID);
+        if (aggregate == nullptr) {
+            return LoanStatus::MemberNotFound;
+        }
+        size_t slot = findBook(bookID);
+        if (slot == NO_SLOT) {
+            return LoanStatus::BookNotFound;
+        }
+        int64_t now = std::time(nullptr);
+        std::lock_guard<std::mutex> memberLock(memberLockFor(memberID));
+        if (aggregate->activeLoans >= static_cast<uint32_t>(std::max(maxActiveLoans, 0))) {
+            return LoanStatus::LoanLimitReached;
+        }
+        size_t allowedOverdue = static_cast<size_t>(std::max(maxOverdueLoans, 0));
+        if (countOverdue(*aggregate, now, allowedOverdue) > allowedOverdue) {
+            return LoanStatus::OverdueLimitReached;
+        }
+        if (!books.claim(slot)) {
+            return LoanStatus::BookUnavailable;
+        }
+        Loan loan(bookID, memberID, now, now + LOAN_PERIOD_DAYS * SECONDS_PER_DAY);
+        LoanStripe& stripe = stripeFor(bookID);
+        std::lock_guard<std::mutex> stripeLock(stripe.mutex);
+        if (!stripe.active.emplace(bookID, loan).second) {
+            // Loaded data had an active loan on a book marked available
+            books.setAvailability(slot, true);
+            return LoanStatus::BookUnavailable;
+        }
+        indexDue(loan);
+        attachToMember(loan);
+        // Appending under the stripe lock keeps the journal order of issues
+        // and returns of one book the same as the order they happened in
+        Journal::Record record(Journal::ISSUE);
+        record.putInt(bookID).putInt(memberID).putInt64(loan.getIssueDate()).putInt64(loan.getDueDate());
+        seq = appendToJournal(record);
+        return LoanStatus::Ok;
+    }
 
-public:
-    Member(int id, std::string n) : memberID(id), name(n) {}
+    LoanStatus returnLocked(int bookID, int memberID, uint64_t& seq) {
+        std::lock_guard<std::mutex> memberLock(memberLockFor(memberID));
+        LoanStripe& stripe = stripeFor(bookID);
+        std::unique_lock<std::mutex> stripeLock(stripe.mutex);
+        auto it = stripe.active.find(bookID);
+        if (it == stripe.active.end() || it->second.getMemberID() != memberID) {
+            return LoanStatus::NoActiveLoan;
+        }
+        Loan loan = it->second;
+        stripe.active.erase(it);
+        unindexDue(loan);
+        detachFromMember(loan);
+        Journal::Record record(Journal::RETURN);
+        record.putInt(bookID).putInt(memberID);
+        seq = appendToJournal(record);
+        stripeLock.unlock();
 
-    int getID() const { return memberID; }
-    std::string getName() const { return name; }
+        loan.closeLoan();
+        {
+            std::lock_guard<std::mutex> historyLock(historyMutex);
+            loanHistory.push_back(loan);
+        }
 
-    void display() const {
-        std::cout << "Member ID: " << memberID << "\nName: " << name << std::endl;
+        size_t slot = findBook(bookID);
+        if (slot != NO_SLOT) {
+            books.setAvailability(slot, true);
+        }
+        return LoanStatus::Ok;
     }
-};
 
-// Loan class
-class Loan {
-private:
-    int bookID;
-    int memberID;
-    bool isActive;
+    std::vector<LoanStatus> applyBatch(const std::vector<std::pair<int, int>>& requests,
+                                       LoanStatus (Library::*apply)(int, int, uint64_t&)) {
+        std::vector<LoanStatus> statuses;
+        if (journal.hasFailed()) {
+            statuses.assign(requests.size(), LoanStatus::NotJournaled);
+            return statuses;
+        }
+        statuses.reserve(requests.size());
+        uint64_t lastSeq = 0;
+        {
+            std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+            for (const auto& request : requests) {
+                uint64_t seq = 0;
+                statuses.push_back((this->*apply)(request.first, request.second, seq));
+                lastSeq = std::max(lastSeq, seq);
+            }
+        }
+        if (lastSeq > 0) {
+            if (!commitChange(lastSeq)) {
+                std::replace(statuses.begin(), statuses.end(), LoanStatus::Ok, LoanStatus::NotJournaled);
+                return statuses;
+            }
+            checkpointIfDue();
+        }
+        return statuses;
+    }
 
 public:
-    Loan(int bID, int mID) : bookID(bID), memberID(mID), isActive(true) {}
-
-    int getBookID() const { return bookID; }
-    int getMemberID() const { return memberID; }
-    bool getStatus() const { return isActive; }
+    // A library that is not durable keeps no journal (used by stress mode)
+    explicit Library(bool durable = true) : journal(durable ? LIBRARY_JOURNAL_FILE : std::string()) {}
 
-    void closeLoan() { isActive = false; }
+    void setVerbose(bool enabled) { verbose = enabled; }
 
-    void display() const {
-        std::cout << "Book ID: " << bookID << "\nMember ID: " << memberID 
-                  << "\nActive: " << (isActive ? "Yes" : "No") << std::endl;
-    }
-};
+    // Set before other threads use the library
+    void setDeferCommits(bool enabled) { deferCommits = enabled; }
 
-// Library class
-class Library {
-private:
-    std::vector<Book> books;
-    std::vector<Member> members;
-    std::vector<Loan> loans;
+    // Makes every change so far durable; false if the journal failed
+    bool syncJournal() { return journal.sync(); }
 
-public:
+    // Throw std::runtime_error if the change cannot be journaled (see commitChange)
     void addBook(const Book& book) {
-        books.push_back(book);
-        std::cout << "Book added successfully.\n";
+        if (journal.hasFailed()) {
+            throw std::runtime_error(describe(LoanStatus::NotJournaled));
+        }
+        uint64_t seq;
+        {
+            std::unique_lock<std::shared_mutex> lock(catalogMutex);
+            storeBook(book.getID(), book.getTitle(), book.getAuthor(), book.getAvailability());
+            Journal::Record record(Journal::ADD_BOOK);
+            record.putInt(book.getID()).putInt(book.getAvailability() ? 1 : 0)
+                  .putString(book.getTitle()).putString(book.getAuthor());
+            seq = appendToJournal(record);
+        }
+        if (!commitChange(seq)) {
+            throw std::runtime_error(describe(LoanStatus::NotJournaled));
+        }
+        if (verbose) {
+            std::cout << "Book added successfully.\n";
+        }
+        checkpointIfDue();
     }
 
     void addMember(const Member& member) {
-        members.push_back(member);
-        std::cout << "Member added successfully.\n";
+        if (journal.hasFailed()) {
+            throw std::runtime_error(describe(LoanStatus::NotJournaled));
+        }
+        uint64_t seq;
+        {
+            std::unique_lock<std::shared_mutex> lock(catalogMutex);
+            storeMember(member);
+            Journal::Record record(Journal::ADD_MEMBER);
+            record.putInt(member.getID()).putString(member.getName());
+            seq = appendToJournal(record);
+        }
+        if (!commitChange(seq)) {
+            throw std::runtime_error(describe(LoanStatus::NotJournaled));
+        }
+        if (verbose) {
+            std::cout << "Member added successfully.\n";
+        }
+        checkpointIfDue();
     }
 
-    void issueBook(int bookID, int memberID) {
-    // Check if the member exists
-    bool memberExists = false;
-    for (const auto& member : members) {
-        if (member.getID() == memberID) {
-            memberExists = true;
-            break;
+    // Issues a book without throwing or printing. Safe to call concurrently
+    // with other issue/return calls.
+    LoanStatus tryIssueBook(int bookID, int memberID) {
+        if (journal.hasFailed()) {
+            return LoanStatus::NotJournaled;
+        }
+        uint64_t seq = 0;
+        LoanStatus status;
+        {
+            std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+            status = issueLocked(bookID, memberID, seq);
+        }
+        if (status == LoanStatus::Ok) {
+            if (!commitChange(seq)) {
+                return LoanStatus::NotJournaled;
+            }
+            checkpointIfDue();
         }
+        return status;
     }
 
-    // If the member is not found, print a message and return
-    if (!memberExists) {
-        std::cerr << RED << "Error: Member not found. Please register the member first." << RESET << std::endl;
-        return;
+    // Returns a book without throwing or printing. Safe to call concurrently
+    // with other issue/return calls.
+    LoanStatus tryReturnBook(int bookID, int memberID) {
+        if (journal.hasFailed()) {
+            return LoanStatus::NotJournaled;
+        }
+        uint64_t seq = 0;
+        LoanStatus status;
+        {
+            std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+            status = returnLocked(bookID, memberID, seq);
+        }
+        if (status == LoanStatus::Ok) {
+            if (!commitChange(seq)) {
+                return LoanStatus::NotJournaled;
+            }
+            checkpointIfDue();
+        }
+        return status;
+    }
+
+    // Bulk variants: one lock acquisition and one journal flush for the whole
+    // batch. Returns one status per (bookID, memberID) request, in order.
+    std::vector<LoanStatus> issueBooks(const std::vector<std::pair<int, int>>& requests) {
+        return applyBatch(requests, &Library::issueLocked);
+    }
+
+    std::vector<LoanStatus> returnBooks(const std::vector<std::pair<int, int>>& requests) {
+        return applyBatch(requests, &Library::returnLocked);
     }
 
-    // Proceed with book issuance if the member exists
-    for (auto& book : books) {
-        if (book.getID() == bookID) {
-            if (!book.getAvailability()) {
-                throw std::runtime_error("Book is currently unavailable.");
+    // Extends an active loan by `days` past its current due date
+    LoanStatus renewLoan(int bookID, int memberID, int days = LOAN_PERIOD_DAYS) {
+        if (journal.hasFailed()) {
+            return LoanStatus::NotJournaled;
+        }
+        uint64_t seq;
+        {
+            std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+            std::lock_guard<std::mutex> memberLock(memberLockFor(memberID));
+            LoanStripe& stripe = stripeFor(bookID);
+            std::lock_guard<std::mutex> stripeLock(stripe.mutex);
+            auto it = stripe.active.find(bookID);
+            if (it == stripe.active.end() || it->second.getMemberID() != memberID) {
+                return LoanStatus::NoActiveLoan;
             }
-            book.setAvailability(false);
-            loans.push_back(Loan(bookID, memberID));
-            std::cout << GREEN << "Book issued successfully." << RESET << std::endl;
-            return;
+            Loan& loan = it->second;
+            int64_t from = loan.getDueDate() != 0 ? loan.getDueDate() : std::time(nullptr);
+            unindexDue(loan);
+            loan.setDueDate(from + days * SECONDS_PER_DAY);
+            indexDue(loan);
+            setMemberDueDate(loan);
+            Journal::Record record(Journal::RENEW);
+            record.putInt(bookID).putInt(memberID).putInt64(loan.getDueDate());
+            seq = appendToJournal(record);
+        }
+        if (!commitChange(seq)) {
+            return LoanStatus::NotJournaled;
         }
+        checkpointIfDue();
+        return LoanStatus::Ok;
     }
 
-    // If the book is not found, throw an error
-    throw std::runtime_error("Book not found.");
-}
+    // Active loans with from <= due date < to, earliest first. Loans recorded
+    // without a due date are never reported.
+    std::vector<Loan> loansDueBetween(int64_t from, int64_t to) const {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        std::vector<std::pair<int64_t, int>> keys;
+        {
+            std::lock_guard<std::mutex> lock(dueMutex);
+            for (auto it = dueIndex.lower_bound({from, INT_MIN}); it != dueIndex.end() && it->first < to; ++it) {
+                keys.push_back(*it);
+            }
+        }
+        std::vector<Loan> result;
+        result.reserve(keys.size());
+        for (const auto& key : keys) {
+            const LoanStripe& stripe = loanStripes[static_cast<uint32_t>(key.second) % LOAN_STRIPES];
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            auto it = stripe.active.find(key.second);
+            // Skip loans returned or renewed since the index was read
+            if (it != stripe.active.end() && it->second.getDueDate() == key.first) {
+                result.push_back(it->second);
+            }
+        }
+        return result;
+    }
 
+    std::vector<Loan> overdueLoans(int64_t asOf) const { return loansDueBetween(INT64_MIN, asOf); }
 
-    void returnBook(int bookID, int memberID) {
-        for (auto& loan : loans) {
-            if (loan.getBookID() == bookID && loan.getMemberID() == memberID && loan.getStatus()) {
-                loan.closeLoan();
-                for (auto& book : books) {
-                    if (book.getID() == bookID) {
-                        book.setAvailability(true);
-                        std::cout << "Book returned successfully.\n";
-                        return;
-                    }
+    // Rebuilds the "borrowed together" index from every loan on record. The
+    // catalog is locked only while loans are collected and while the new
+    // index is swapped in.
+    void rebuildRecommendations(size_t perBook = RECOMMENDATIONS_PER_BOOK) {
+        std::vector<std::pair<uint32_t, uint32_t>> loans;
+        uint32_t memberCount, bookCount;
+        {
+            std::unique_lock<std::shared_mutex> lock(catalogMutex);
+            loans.reserve(loanHistory.size() + activeLoanCount());
+            auto collect = [&](const Loan& loan) {
+                auto member = memberIndex.find(loan.getMemberID());
+                size_t slot = findBook(loan.getBookID());
+                if (member != memberIndex.end() && slot != NO_SLOT) {
+                    loans.emplace_back(static_cast<uint32_t>(member->second), static_cast<uint32_t>(slot));
                 }
+            };
+            for (const auto& loan : loanHistory) {
+                collect(loan);
             }
+            forEachActiveLoan(collect);
+            memberCount = static_cast<uint32_t>(members.size());
+            bookCount = static_cast<uint32_t>(books.size());
         }
-        throw std::runtime_error("No active loan found for the given book and member.");
+        CoBorrowIndex rebuilt;
+        rebuilt.build(std::move(loans), memberCount, bookCount, perBook);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        coBorrowIndex = std::move(rebuilt);
     }
 
-    void saveData() {
-    std::ofstream file("library_data.txt");
-    if (!file) {
-        std::cerr << "Error opening file for saving data.\n";
-        return;
+    // Books most often borrowed by members who also borrowed bookID
+    std::vector<Book> recommendBooks(int bookID, size_t count) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::vector<Book> result;
+        size_t slot = findBook(bookID);
+        if (slot == NO_SLOT) {
+            return result;
+        }
+        auto range = coBorrowIndex.neighborsOf(static_cast<uint32_t>(slot));
+        for (auto it = range.first; it != range.second && result.size() < count; ++it) {
+            result.push_back(books.getBook(it->slot));
+        }
+        return result;
     }
 
-    // Save books
-    file << "Books:\n";
-    for (const auto& book : books) {
-        file << book.getID() << "|" << book.getTitle() << "|" << book.getAuthor() 
-             << "|" << (book.getAvailability() ? "1" : "0") << "\n";
+    // A negative limit blocks all new loans
+    void setLoanLimits(int maxActive, int maxOverdue) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        maxActiveLoans = maxActive;
+        maxOverdueLoans = maxOverdue;
     }
 
-    // Save members
-    file << "Members:\n";
-    for (const auto& member : members) {
-        file << member.getID() << "|" << member.getName() << "\n";
+    MemberLoanSummary getLoanSummary(int memberID, int64_t asOf) const {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        MemberLoanSummary summary;
+        auto it = memberIndex.find(memberID);
+        if (it == memberIndex.end()) {
+            return summary;
+        }
+        std::lock_guard<std::mutex> memberLock(memberLockFor(memberID));
+        const MemberLoans& aggregate = memberLoans[it->second];
+        summary.activeLoans = aggregate.activeLoans;
+        summary.overdueLoans = countOverdue(aggregate, asOf, SIZE_MAX);
+        summary.totalBorrowed = aggregate.totalBorrowed;
+        return summary;
     }
 
-    // Save loans
-    file << "Loans:\n";
-    for (const auto& loan : loans) {
-        file << loan.getBookID() << "|" << loan.getMemberID() 
-             << "|" << (loan.getStatus() ? "1" : "0") << "\n";
+    // The member's active loans, most recently issued first
+    std::vector<Loan> loansForMember(int memberID) const {
+        std::shared_lock<std::shared_mutex> catalogLock(catalogMutex);
+        std::vector<Loan> result;
+        auto it = memberIndex.find(memberID);
+        if (it == memberIndex.end()) {
+            return result;
+        }
+        std::lock_guard<std::mutex> memberLock(memberLockFor(memberID));
+        for (uint32_t slot = memberLoans[it->second].firstSlot; slot != NO_LINK; slot = loanLinks[slot].next) {
+            int bookID = books.getID(slot);
+            const LoanStripe& stripe = loanStripes[static_cast<uint32_t>(bookID) % LOAN_STRIPES];
+            std::lock_guard<std::mutex> stripeLock(stripe.mutex);
+            auto loan = stripe.active.find(bookID);
+            if (loan != stripe.active.end()) {
+                result.push_back(loan->second);
+            }
+        }
+        return result;
     }
 
-    file.close();
-    std::cout << "Data saved successfully.\n";
-}
-
+    void issueBook(int bookID, int memberID) {
+    LoanStatus status = tryIssueBook(bookID, memberID);
 
-    void loadData() {
-    std::ifstream file("library_data.txt");
-    if (!file) {
-        std::cerr << "Error opening file for loading data.\n";
+    // If the member is not found, print a message and return
+    if (status == LoanStatus::MemberNotFound) {
+        std::cerr << RED << "Error: Member not found. Please register the member first." << RESET << std::endl;
         return;
     }
-    
-    std::string line;
-    enum Section { NONE, BOOKS, MEMBERS, LOANS };
-    Section currentSection = NONE;
-
-    while (std::getline(file, line)) {
-        if (line == "Books:") {
-            currentSection = BOOKS;
-            continue;
-        } else if (line == "Members:") {
-            currentSection = MEMBERS;
-            continue;
-        } else if (line == "Loans:") {
-            currentSection = LOANS;
-            continue;
-        }
-
-        if (currentSection == BOOKS) {
-            // Parse book data
-            int bookID;
-            std::string title, author;
-            bool isAvailable;
-
-            size_t pos1 = line.find('|');
-            size_t pos2 = line.find('|', pos1 + 1);
-            size_t pos3 = line.find('|', pos2 + 1);
-
-            bookID = std::stoi(line.substr(0, pos1));
-            title = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            author = line.substr(pos2 + 1, pos3 - pos2 - 1);
-            isAvailable = line.substr(pos3 + 1) == "1";
-
-            books.push_back(Book(bookID, title, author));
-            books.back().setAvailability(isAvailable);
+    if (status != LoanStatus::Ok) {
+        throw std::runtime_error(describe(status));
+    }
+    if (verbose) {
+        std::cout << GREEN << "Book issued successfully." << RESET << std::endl;
+    }
+}
 
-        } else if (currentSection == MEMBERS) {
-            // Parse member data
-            int memberID;
-            std::string name;
 
-            size_t pos = line.find('|');
-            memberID = std::stoi(line.substr(0, pos));
-            name = line.substr(pos + 1);
+    void returnBook(int bookID, int memberID) {
+        LoanStatus status = tryReturnBook(bookID, memberID);
+        if (status != LoanStatus::Ok) {
+            throw std::runtime_error(describe(status));
+        }
+        if (verbose) {
+            std::cout << "Book returned successfully.\n";
+        }
+    }
 
-            members.push_back(Member(memberID, name));
+    bool saveData(DataFormat format = DataFormat::Text) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        if (!saveLocked(format)) {
+            return false;
+        }
+        if (verbose) {
+            std::cout << "Data saved successfully.\n";
+        }
+        return true;
+    }
 
-        } else if (currentSection == LOANS) {
-            // Parse loan data
-            int bookID, memberID;
-            bool isActive;
+    // Loads a save and, when the library was empty, replays the journal
+    // written since that save
+    bool loadData(DataFormat format = DataFormat::Text) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        bool wasEmpty = isEmpty();
+        size_t firstNewBook = books.size();
+        uint32_t loadedGeneration = 0;
+        bool loaded = format == DataFormat::Binary ? loadSnapshot(loadedGeneration) : loadText(loadedGeneration);
 
-            size_t pos1 = line.find('|');
-            size_t pos2 = line.find('|', pos1 + 1);
+        // A journal written before anything was ever saved extends an empty library
+        bool journalOnly = !loaded && wasEmpty && journal.getGeneration() == 0 && journal.getRecordCount() > 0;
+        if (!loaded && !journalOnly) {
+            return false;
+        }
 
-            bookID = std::stoi(line.substr(0, pos1));
-            memberID = std::stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
-            isActive = line.substr(pos2 + 1) == "1";
+        size_t replayed = 0;
+        if (wasEmpty) {
+            if (journal.getGeneration() == loadedGeneration) {
+                replayed = journal.replay([this](uint8_t type, Journal::Cursor cursor) { applyRecord(type, cursor); });
+            } else {
+                if (journal.getRecordCount() > 0) {
+                    std::cerr << "Warning: " << LIBRARY_JOURNAL_FILE << " does not extend this save; moved it to "
+                              << LIBRARY_JOURNAL_FILE << ".old without replaying.\n";
+                }
+                journal.reset(loadedGeneration, true);
+            }
+            generation = loadedGeneration;
+            lastFormat = format;
+            journalAttached.store(true, std::memory_order_release);
+        }
+        indexTextFrom(firstNewBook);
 
-            loans.push_back(Loan(bookID, memberID));
-            if (!isActive) {
-                loans.back().closeLoan();
+        if (verbose) {
+            std::cout << "Data loaded successfully.\n";
+            if (replayed > 0) {
+                std::cout << "Recovered " << replayed << " change(s) from " << LIBRARY_JOURNAL_FILE << ".\n";
             }
         }
+        return true;
     }
 
-    file.close();
-    std::cout << "Data loaded successfully.\n";
-}
-
+    // Books whose title/author contain every word of the query ("word*" for a
+    // prefix), in catalog order. Returns at most pageSize books starting at
+    // match number page * pageSize.
+    SearchPage searchBooks(std::string_view query, size_t page, size_t pageSize, bool availableOnly = false) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        SearchPage result;
+        size_t first = page * pageSize;
+        for (uint32_t slot : searchIndex.search(query)) {
+            if (availableOnly && !books.getAvailability(slot)) {
+                continue;
+            }
+            if (result.totalMatches >= first && result.books.size() < pageSize) {
+                result.books.push_back(books.getBook(slot));
+            }
+            ++result.totalMatches;
+        }
+        return result;
+    }
 
     void displayBooks() const {
-        for (const auto& book : books) {
-            book.display();
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        for (size_t slot = 0; slot < books.size(); ++slot) {
+            books.getBook(slot).display();
             std::cout << "-------------------------\n";
         }
     }
 
     void displayMembers() const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
         for (const auto& member : members) {
             member.display();
             std::cout << "-------------------------\n";
@@ -265,18 +2413,357 @@ public:
     }
 
     void displayLoans() const {
-        for (const auto& loan : loans) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        for (const auto& loan : loanHistory) {
+            loan.display();
+            std::cout << "-------------------------\n";
+        }
+        forEachActiveLoan([](const Loan& loan) {
             loan.display();
             std::cout << "-------------------------\n";
+        });
+    }
+
+    // Cross-checks the loan bookkeeping: availability bits, the due index
+    // and the per-member aggregates must all agree with the active loans.
+    // Prints each mismatch to stderr and returns how many there were.
+    size_t checkConsistency() const {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        size_t problems = 0;
+        auto report = [&problems](const std::string& message) {
+            std::cerr << "Inconsistent: " << message << "\n";
+            ++problems;
+        };
+
+        std::vector<uint32_t> loansOf(members.size(), 0);
+        for (size_t i = 0; i < LOAN_STRIPES; ++i) {
+            for (const auto& entry : loanStripes[i].active) {
+                const Loan& loan = entry.second;
+                std::string which = "loan of book " + std::to_string(entry.first);
+                size_t slot = findBook(entry.first);
+                auto member = memberIndex.find(loan.getMemberID());
+                if (loan.getBookID() != entry.first || static_cast<uint32_t>(entry.first) % LOAN_STRIPES != i) {
+                    report(which + " is filed under the wrong book or stripe");
+                }
+                if (slot == NO_SLOT || books.getAvailability(slot)) {
+                    report(which + " is on a missing or available book");
+                }
+                if (member == memberIndex.end()) {
+                    report(which + " is to a missing member");
+                } else {
+                    ++loansOf[member->second];
+                }
+                if (loan.getDueDate() != 0 && dueIndex.count({loan.getDueDate(), entry.first}) == 0) {
+                    report(which + " is missing from the due index");
+                }
+            }
+        }
+        if (dueIndex.size() > activeLoanCount()) {
+            report("the due index has entries for loans that are not active");
+        }
+        for (size_t slot = 0; slot < books.size(); ++slot) {
+            int bookID = books.getID(slot);
+            const LoanStripe& stripe = loanStripes[static_cast<uint32_t>(bookID) % LOAN_STRIPES];
+            if (!books.getAvailability(slot) && stripe.active.count(bookID) == 0 && findBook(bookID) == slot) {
+                report("book " + std::to_string(bookID) + " is out with no active loan");
+            }
+        }
+
+        std::vector<uint64_t> borrowed(members.size(), 0);
+        for (const auto& loan : loanHistory) {
+            auto member = memberIndex.find(loan.getMemberID());
+            if (member != memberIndex.end()) {
+                ++borrowed[member->second];
+            }
+        }
+        for (size_t pos = 0; pos < members.size(); ++pos) {
+            if (memberIndex.at(members[pos].getID()) != pos) {
+                continue; // a duplicate ID; its loans count against the first
+            }
+            const MemberLoans& aggregate = memberLoans[pos];
+            std::string which = "member " + std::to_string(members[pos].getID());
+            uint32_t linked = 0;
+            for (uint32_t slot = aggregate.firstSlot; slot != NO_LINK && linked <= books.size();
+                 slot = loanLinks[slot].next) {
+                int bookID = books.getID(slot);
+                const LoanStripe& stripe = loanStripes[static_cast<uint32_t>(bookID) % LOAN_STRIPES];
+                auto loan = stripe.active.find(bookID);
+                if (loan == stripe.active.end() || loan->second.getMemberID() != members[pos].getID()) {
+                    report(which + " lists book " + std::to_string(bookID) + " it does not have");
+                }
+                ++linked;
+            }
+            if (aggregate.activeLoans != loansOf[pos] || linked != loansOf[pos]) {
+                report(which + " counts " + std::to_string(aggregate.activeLoans) + " active loans and lists "
+                       + std::to_string(linked) + " but has " + std::to_string(loansOf[pos]));
+            }
+            if (aggregate.totalBorrowed != borrowed[pos] + loansOf[pos]) {
+                report(which + " counts " + std::to_string(aggregate.totalBorrowed) + " loans ever but has "
+                       + std::to_string(borrowed[pos] + loansOf[pos]));
+            }
         }
+        return problems;
     }
 };
 
+// Batch mode: one command per line, fields separated by '|' as in the data file
+//   ADD_BOOK|id|title|author    ADD_MEMBER|id|name
+//   ISSUE|bookID|memberID       RETURN|bookID|memberID
+//   SAVE[|BINARY]               LOAD[|BINARY]
+// Blank lines and lines starting with '#' are ignored. Each command produces
+// "line|OK" or "line|ERR|message" on stdout; a summary goes to stderr.
+int runBatch(Library& lib, std::istream& in) {
+    lib.setVerbose(false);
+    lib.setDeferCommits(true);
+    DelimitedReader reader(in);
+    size_t ops = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Results are only printed once the changes they report are durable. A
+    // change whose OK is still waiting when the journal fails is reported
+    // as not journaled instead.
+    struct Reply {
+        size_t line;
+        std::string error;
+        bool journaled; // an OK that depends on the next sync
+    };
+    std::vector<Reply> replies;
+    auto commitReplies = [&]() {
+        bool synced = lib.syncJournal();
+        std::string out;
+        for (Reply& reply : replies) {
+            if (reply.journaled && !synced) {
+                reply.error = describe(LoanStatus::NotJournaled);
+                ++failed;
+            }
+            out += std::to_string(reply.line);
+            out += reply.error.empty() ? "|OK\n" : "|ERR|" + reply.error + '\n';
+        }
+        std::cout << out;
+        replies.clear();
+    };
+
+    while (reader.next()) {
+        std::string_view line = reader.getLine();
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        const auto& fields = reader.getFields();
+        std::string_view command = fields[0];
+        std::string error;
+        bool journaled = command == "ADD_BOOK" || command == "ADD_MEMBER" || command == "ISSUE" || command == "RETURN";
+        int first, second;
+        try {
+            if (command == "ADD_BOOK" && fields.size() == 4 && parseInt(fields[1], first)) {
+                lib.addBook(Book(first, std::string(fields[2]), std::string(fields[3])));
+            } else if (command == "ADD_MEMBER" && fields.size() >= 3 && parseInt(fields[1], first)) {
+                size_t nameStart = fields[0].size() + fields[1].size() + 2;
+                lib.addMember(Member(first, std::string(line.substr(nameStart))));
+            } else if ((command == "ISSUE" || command == "RETURN") && fields.size() == 3
+                       && parseInt(fields[1], first) && parseInt(fields[2], second)) {
+                LoanStatus status = command == "ISSUE" ? lib.tryIssueBook(first, second)
+                                                       : lib.tryReturnBook(first, second);
+                if (status != LoanStatus::Ok) {
+                    error = describe(status);
+                }
+            } else if ((command == "SAVE" || command == "LOAD")
+                       && (fields.size() == 1 || (fields.size() == 2 && fields[1] == "BINARY"))) {
+                commitReplies();
+                DataFormat format = fields.size() == 2 ? DataFormat::Binary : DataFormat::Text;
+                bool ok = command == "SAVE" ? lib.saveData(format) : lib.loadData(format);
+                if (!ok) {
+                    error = command == "SAVE" ? "Save failed." : "Load failed.";
+                }
+            } else {
+                error = "Unknown or malformed command.";
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        ++ops;
+        if (!error.empty()) {
+            ++failed;
+            journaled = false;
+        }
+        replies.push_back(Reply{reader.getLineNumber(), std::move(error), journaled});
+        if (replies.size() >= BATCH_COMMIT_LINES) {
+            commitReplies();
+        }
+    }
+    commitReplies();
+    std::cout.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "batch: " << ops << " ops, " << failed << " failed, " << seconds << " s, "
+              << (seconds > 0 ? ops / seconds : 0.0) << " ops/sec\n";
+    return failed == 0 ? 0 : 1;
+}
+
+// Stress mode: threads issue, return and renew books of one small library
+// at once, singly and in bulk, so most requests contend for the same books
+// and members. Afterwards the loan bookkeeping is cross-checked and the
+// loans each thread saw succeed are matched against the library's counts.
+// Nothing is journaled or saved. Returns 0 if everything agrees.
+int runStress(size_t threadCount, size_t opsPerThread) {
+    const int BOOKS = 256, MEMBERS = 64, BULK = 8;
+    Library lib(false);
+    lib.setVerbose(false);
+    for (int id = 1; id <= BOOKS; ++id) {
+        lib.addBook(Book(id, "Book " + std::to_string(id), "Author " + std::to_string(id % 17)));
+    }
+    for (int id = 1; id <= MEMBERS; ++id) {
+        lib.addMember(Member(id, "Member " + std::to_string(id)));
+    }
+
+    // unexpected counts returns of a thread's own loans that failed and
+    // returns for a member with no loans that succeeded
+    std::atomic<uint64_t> issued{0}, returned{0}, outstanding{0}, unexpected{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 random(static_cast<uint32_t>(t + 1));
+            auto pick = [&random](int count) { return static_cast<int>(random() % count) + 1; };
+            // Loans this thread made and has not returned; only it returns them
+            std::vector<std::pair<int, int>> mine;
+            auto takeMine = [&]() {
+                size_t i = random() % mine.size();
+                std::pair<int, int> loan = mine[i];
+                mine[i] = mine.back();
+                mine.pop_back();
+                return loan;
+            };
+            uint64_t issues = 0, returns = 0, wrong = 0;
+            for (size_t op = 0; op < opsPerThread; ++op) {
+                switch (random() % 8) {
+                case 0:
+                case 1:
+                case 2: {
+                    std::pair<int, int> request(pick(BOOKS), pick(MEMBERS));
+                    if (lib.tryIssueBook(request.first, request.second) == LoanStatus::Ok) {
+                        mine.push_back(request);
+                        ++issues;
+                    }
+                    break;
+                }
+                case 3: {
+                    std::vector<std::pair<int, int>> requests;
+                    for (int i = 0; i < BULK; ++i) {
+                        requests.emplace_back(pick(BOOKS), pick(MEMBERS));
+                    }
+                    std::vector<LoanStatus> statuses = lib.issueBooks(requests);
+                    for (size_t i = 0; i < requests.size(); ++i) {
+                        if (statuses[i] == LoanStatus::Ok) {
+                            mine.push_back(requests[i]);
+                            ++issues;
+                        }
+                    }
+                    break;
+                }
+                case 4:
+                case 5:
+                    if (!mine.empty()) {
+                        std::pair<int, int> loan = takeMine();
+                        if (lib.tryReturnBook(loan.first, loan.second) == LoanStatus::Ok) {
+                            ++returns;
+                        } else {
+                            ++wrong;
+                        }
+                    }
+                    break;
+                case 6: {
+                    std::vector<std::pair<int, int>> requests;
+                    while (!mine.empty() && requests.size() < static_cast<size_t>(BULK)) {
+                        requests.push_back(takeMine());
+                    }
+                    // A member with no loans: must be refused
+                    requests.emplace_back(pick(BOOKS), MEMBERS + 1);
+                    std::vector<LoanStatus> statuses = lib.returnBooks(requests);
+                    for (size_t i = 0; i + 1 < requests.size(); ++i) {
+                        if (statuses[i] == LoanStatus::Ok) {
+                            ++returns;
+                        } else {
+                            ++wrong;
+                        }
+                    }
+                    wrong += statuses.back() != LoanStatus::NoActiveLoan;
+                    break;
+                }
+                default:
+                    if (!mine.empty()) {
+                        const std::pair<int, int>& loan = mine[random() % mine.size()];
+                        wrong += lib.renewLoan(loan.first, loan.second, 1) != LoanStatus::Ok;
+                    }
+                    lib.getLoanSummary(pick(MEMBERS), std::time(nullptr));
+                    break;
+                }
+            }
+            issued += issues;
+            returned += returns;
+            outstanding += mine.size();
+            unexpected += wrong;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t problems = lib.checkConsistency();
+    uint64_t active = 0, borrowed = 0;
+    for (int id = 1; id <= MEMBERS; ++id) {
+        MemberLoanSummary summary = lib.getLoanSummary(id, 0);
+        active += summary.activeLoans;
+        borrowed += summary.totalBorrowed;
+    }
+    if (unexpected > 0) {
+        std::cerr << "Inconsistent: " << unexpected << " return(s) or renewal(s) got the wrong answer.\n";
+        ++problems;
+    }
+    if (active != issued - returned || active != outstanding || borrowed != issued) {
+        std::cerr << "Inconsistent: threads issued " << issued << ", returned " << returned << " and hold "
+                  << outstanding << " loans, but the library has " << active << " active of " << borrowed
+                  << " borrowed.\n";
+        ++problems;
+    }
+    std::cerr << "stress: " << threadCount << " threads, " << threadCount * opsPerThread << " ops, " << issued
+              << " issued, " << returned << " returned, " << seconds << " s, "
+              << (problems == 0 ? "consistent" : std::to_string(problems) + " problem(s)") << "\n";
+    return problems == 0 ? 0 : 1;
+}
+
 // Main function with console interface
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--stress") {
+        // --stress [THREADS] [OPS_PER_THREAD]
+        size_t counts[2] = {std::max<size_t>(4, std::thread::hardware_concurrency()), 200000};
+        for (int i = 2; i < argc; ++i) {
+            if (i > 3 || !parseInt(std::string_view(argv[i]), counts[i - 2]) || counts[i - 2] == 0) {
+                std::cerr << "Usage: " << argv[0] << " --stress [THREADS] [OPS_PER_THREAD]\n";
+                return 1;
+            }
+        }
+        return runStress(counts[0], counts[1]);
+    }
+
     Library lib;
     int choice;
 
+    if (argc >= 2 && std::string(argv[1]) == "--batch") {
+        std::ios::sync_with_stdio(false);
+        if (argc < 3 || std::string(argv[2]) == "-") {
+            return runBatch(lib, std::cin);
+        }
+        std::ifstream batchFile(argv[2], std::ios::binary);
+        if (!batchFile) {
+            std::cerr << "Error opening batch file " << argv[2] << ".\n";
+            return 1;
+        }
+        return runBatch(lib, batchFile);
+    }
+
     do {
         // Styling the header
         std::cout << BOLD << BLUE << "\n===== Library Management System =====\n" << RESET;
@@ -292,6 +2779,15 @@ int main() {
         std::cout << CYAN << "7. Display All Loans\n" << RESET;
         std::cout << CYAN << "8. Save Data\n" << RESET;
         std::cout << CYAN << "9. Load Data\n" << RESET;
+        std::cout << CYAN << "10. Save Binary Snapshot\n" << RESET;
+        std::cout << CYAN << "11. Load Binary Snapshot\n" << RESET;
+        std::cout << CYAN << "12. Search Books\n" << RESET;
+        std::cout << CYAN << "13. Show Overdue Loans\n" << RESET;
+        std::cout << CYAN << "14. Show Loans Due in the Next 24 Hours\n" << RESET;
+        std::cout << CYAN << "15. Renew Loan\n" << RESET;
+        std::cout << CYAN << "16. Show a Member's Loans\n" << RESET;
+        std::cout << CYAN << "17. Rebuild Recommendations\n" << RESET;
+        std::cout << CYAN << "18. Show Books Borrowed Together\n" << RESET;
         std::cout << CYAN << "0. Exit\n" << RESET;
 
         std::cout << BOLD << "Enter your choice: " << RESET;
@@ -317,7 +2813,11 @@ int main() {
             std::getline(std::cin, title);
             std::cout << "Enter Author Name: ";
             std::getline(std::cin, author);
-            lib.addBook(Book(id, title, author));
+            try {
+                lib.addBook(Book(id, title, author));
+            } catch (const std::exception& e) {
+                std::cerr << RED << "Error: " << e.what() << RESET << std::endl;
+            }
             break;
         }
         case 2: {
@@ -329,7 +2829,11 @@ int main() {
             std::cin.ignore(); // To clear newline from the input buffer
             std::cout << "Enter Member Name: ";
             std::getline(std::cin, name);
-            lib.addMember(Member(id, name));
+            try {
+                lib.addMember(Member(id, name));
+            } catch (const std::exception& e) {
+                std::cerr << RED << "Error: " << e.what() << RESET << std::endl;
+            }
             break;
         }
         case 3: {
@@ -385,6 +2889,101 @@ int main() {
             lib.loadData();
             break;
         }
+        case 10: {
+            std::cout << BOLD << GREEN << "\nSaving Binary Snapshot...\n" << RESET;
+            lib.saveData(DataFormat::Binary);
+            break;
+        }
+        case 11: {
+            std::cout << BOLD << GREEN << "\nLoading Binary Snapshot...\n" << RESET;
+            lib.loadData(DataFormat::Binary);
+            break;
+        }
+        case 12: {
+            const size_t pageSize = 10;
+            std::string query, filter;
+            size_t page;
+            std::cout << BOLD << GREEN << "\nSearching Books\n" << RESET;
+            std::cin.ignore(); // To clear newline from the input buffer
+            std::cout << "Enter keywords (end a word with * to match a prefix): ";
+            std::getline(std::cin, query);
+            std::cout << "Only available books? (y/n): ";
+            std::cin >> filter;
+            std::cout << "Page number (starting at 1): ";
+            std::cin >> page;
+            if (page == 0) {
+                page = 1;
+            }
+            SearchPage results = lib.searchBooks(query, page - 1, pageSize, filter == "y" || filter == "Y");
+            for (const auto& book : results.books) {
+                book.display();
+                std::cout << "-------------------------\n";
+            }
+            std::cout << "Showing " << results.books.size() << " of " << results.totalMatches << " matches.\n";
+            break;
+        }
+        case 13:
+        case 14: {
+            int64_t now = std::time(nullptr);
+            std::vector<Loan> due = choice == 13 ? lib.overdueLoans(now)
+                                                 : lib.loansDueBetween(now, now + SECONDS_PER_DAY);
+            std::cout << BOLD << GREEN << (choice == 13 ? "\nOverdue Loans\n" : "\nLoans Due in the Next 24 Hours\n") << RESET;
+            for (const auto& loan : due) {
+                loan.display();
+                std::cout << "-------------------------\n";
+            }
+            std::cout << due.size() << " loan(s).\n";
+            break;
+        }
+        case 15: {
+            int bookID, memberID;
+            std::cout << BOLD << GREEN << "\nRenewing a Loan\n" << RESET;
+            std::cout << "Enter Book ID to Renew: ";
+            std::cin >> bookID;
+            std::cout << "Enter Member ID: ";
+            std::cin >> memberID;
+            LoanStatus status = lib.renewLoan(bookID, memberID);
+            if (status == LoanStatus::Ok) {
+                std::cout << GREEN << "Loan renewed for " << LOAN_PERIOD_DAYS << " more days." << RESET << std::endl;
+            } else {
+                std::cerr << RED << "Error: " << describe(status) << RESET << std::endl;
+            }
+            break;
+        }
+        case 16: {
+            int memberID;
+            std::cout << "Enter Member ID: ";
+            std::cin >> memberID;
+            MemberLoanSummary summary = lib.getLoanSummary(memberID, std::time(nullptr));
+            std::cout << BOLD << GREEN << "\nLoans of Member " << memberID << "\n" << RESET;
+            for (const auto& loan : lib.loansForMember(memberID)) {
+                loan.display();
+                std::cout << "-------------------------\n";
+            }
+            std::cout << summary.activeLoans << " active (" << summary.overdueLoans << " overdue), "
+                      << summary.totalBorrowed << " borrowed in total.\n";
+            break;
+        }
+        case 17: {
+            lib.rebuildRecommendations();
+            std::cout << GREEN << "Recommendations rebuilt." << RESET << std::endl;
+            break;
+        }
+        case 18: {
+            int bookID;
+            std::cout << "Enter Book ID: ";
+            std::cin >> bookID;
+            std::vector<Book> together = lib.recommendBooks(bookID, RECOMMENDATIONS_PER_BOOK);
+            std::cout << BOLD << GREEN << "\nMembers who borrowed this also borrowed\n" << RESET;
+            for (const auto& book : together) {
+                book.display();
+                std::cout << "-------------------------\n";
+            }
+            if (together.empty()) {
+                std::cout << "No recommendations (use option 17 to rebuild them).\n";
+            }
+            break;
+        }
         case 0: {
             std::cout << BOLD << GREEN << "Exiting the system. Goodbye!\n" << RESET;
             break;
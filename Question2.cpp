@@ -3,45 +3,485 @@
 #include <string>
 #include <fstream>
 #include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <random>
 
-// Room Base Class
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <csignal>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+const std::string HOTEL_DATA_FILE = "hotel_data.txt";
+const std::string HOTEL_JOURNAL_FILE = "hotel_journal.bin";
+
+// Once the journal holds this many records, a background thread seals it
+// and folds it into a fresh snapshot
+const size_t JOURNAL_COMPACT_RECORDS = 1000000;
+
+// The booking log is swept into the archive once at least this many of its
+// entries are cancelled and they make up half of it
+const size_t ARCHIVE_MIN_BOOKINGS = 65536;
+
+// Rooms per page of the availability listing
+const size_t ROOM_PAGE_SIZE = 20;
+
+// Streams a pipe-delimited text file in large blocks and splits each line
+// into string_view fields without allocating per field. The views stay
+// valid until the next call to next().
+class DelimitedReader {
+private:
+    std::ifstream file;
+    std::vector<char> buffer;
+    size_t pos = 0;          // start of the unconsumed data
+    size_t end = 0;          // end of the valid data
+    bool eof = false;
+    size_t lineNumber = 0;
+    std::vector<size_t> cuts; // '|' offsets within the current line
+    std::string_view line;
+    std::vector<std::string_view> fields;
+
+    // Index of the first '|' or '\n' in [from, end), or end if there is none
+    size_t findDelimiter(size_t from) const {
+        const char* data = buffer.data();
+#ifdef __SSE2__
+        const __m128i pipe = _mm_set1_epi8('|');
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; from + 16 <= end; from += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, pipe),
+                                                      _mm_cmpeq_epi8(chunk, newline)));
+            if (mask != 0) {
+                return from + __builtin_ctz(mask);
+            }
+        }
+#endif
+        for (; from < end; ++from) {
+            if (data[from] == '|' || data[from] == '\n') {
+                return from;
+            }
+        }
+        return end;
+    }
+
+    // Moves the partial line to the front of the buffer and reads more data
+    bool refill() {
+        if (eof) {
+            return false;
+        }
+        if (pos > 0) {
+            std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        file.read(buffer.data() + end, buffer.size() - end);
+        size_t got = static_cast<size_t>(file.gcount());
+        if (got == 0) {
+            eof = true;
+            return false;
+        }
+        end += got;
+        return true;
+    }
+
+public:
+    explicit DelimitedReader(const std::string& path, size_t blockSize = 1 << 20)
+        : file(path, std::ios::binary), buffer(blockSize) {}
+
+    bool isOpen() const { return static_cast<bool>(file); }
+    size_t getLineNumber() const { return lineNumber; }
+    std::string_view getLine() const { return line; }
+    const std::vector<std::string_view>& getFields() const { return fields; }
+
+    // Advances to the next line. Returns false once the file is exhausted.
+    bool next() {
+        cuts.clear();
+        size_t scanned = 0; // bytes of the current line already searched
+        size_t hit;
+        while (true) {
+            hit = findDelimiter(pos + scanned);
+            if (hit == end) {
+                scanned = end - pos;
+                if (refill()) {
+                    continue;
+                }
+                if (scanned == 0) {
+                    return false;
+                }
+                hit = end; // last line has no trailing newline
+                break;
+            }
+            if (buffer[hit] == '|') {
+                cuts.push_back(hit - pos);
+                scanned = hit - pos + 1;
+                continue;
+            }
+            break;
+        }
+
+        const char* start = buffer.data() + pos;
+        size_t length = hit - pos;
+        if (length > 0 && start[length - 1] == '\r') {
+            --length;
+        }
+        line = std::string_view(start, length);
+        fields.clear();
+        size_t fieldStart = 0;
+        for (size_t cut : cuts) {
+            fields.emplace_back(start + fieldStart, cut - fieldStart);
+            fieldStart = cut + 1;
+        }
+        fields.emplace_back(start + fieldStart, length - fieldStart);
+
+        pos = hit == end ? end : hit + 1;
+        ++lineNumber;
+        return true;
+    }
+};
+
+template <typename Int>
+inline bool parseInt(std::string_view text, Int& value) {
+    const char* last = text.data() + text.size();
+    auto result = std::from_chars(text.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline bool parseFlag(std::string_view text, bool& value) {
+    if (text != "0" && text != "1") {
+        return false;
+    }
+    value = text == "1";
+    return true;
+}
+// Dates are whole days since 1970-01-01, written as YYYY-MM-DD
+inline int daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int>(dayOfEra) - 719468;
+}
+
+inline bool parseDate(std::string_view text, int& days) {
+    int year, month, day;
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-' || !parseInt(text.substr(0, 4), year)
+        || !parseInt(text.substr(5, 2), month) || !parseInt(text.substr(8, 2), day) || month < 1 || month > 12
+        || day < 1) {
+        return false;
+    }
+    static const int monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > monthDays[month - 1] + (month == 2 && leap ? 1 : 0)) {
+        return false;
+    }
+    days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    return true;
+}
+
+inline std::string formatDate(int days) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+    unsigned day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    unsigned month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    int year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u", year, month, day);
+    return buffer;
+}
+
+// The current UTC date in the same numbering
+inline int today() {
+    auto hours = std::chrono::duration_cast<std::chrono::hours>(std::chrono::system_clock::now().time_since_epoch());
+    return static_cast<int>(hours.count() / 24);
+}
+
+enum class RoomType : uint8_t { Single, Double, Suite };
+const size_t ROOM_TYPE_COUNT = 3;
+
+inline const char* roomTypeName(RoomType type) {
+    switch (type) {
+    case RoomType::Single:
+        return "Single";
+    case RoomType::Double:
+        return "Double";
+    case RoomType::Suite:
+        return "Suite";
+    }
+    return "Unknown";
+}
+
+inline bool parseRoomType(std::string_view text, RoomType& type) {
+    if (text == "Single") {
+        type = RoomType::Single;
+    } else if (text == "Double") {
+        type = RoomType::Double;
+    } else if (text == "Suite") {
+        type = RoomType::Suite;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Room types differ only by name, so a room is a small value (8 bytes)
+// stored contiguously in Hotel::rooms rather than a heap-allocated subclass
 class Room {
-protected:
     int roomNumber;
-    std::string roomType;
+    RoomType roomType;
     bool isAvailable;
 
 public:
-    Room(int roomNumber, const std::string& roomType) : roomNumber(roomNumber), roomType(roomType), isAvailable(true) {}
-
-    virtual ~Room() {}
+    Room(int roomNumber, RoomType roomType) : roomNumber(roomNumber), roomType(roomType), isAvailable(true) {}
 
     int getRoomNumber() const { return roomNumber; }
-    std::string getRoomType() const { return roomType; }
+    RoomType getRoomType() const { return roomType; }
     bool getAvailability() const { return isAvailable; }
 
     void setAvailability(bool available) { isAvailable = available; }
 
-    virtual void displayDetails() const {
-        std::cout << "Room Number: " << roomNumber << " | Type: " << roomType << " | " 
+    void displayDetails() const {
+        std::cout << "Room Number: " << roomNumber << " | Type: " << roomTypeName(roomType) << " | " 
                   << (isAvailable ? "Available" : "Not Available") << std::endl;
     }
 };
 
-// Derived Classes for Different Room Types
-class SingleRoom : public Room {
-public:
-    SingleRoom(int roomNumber) : Room(roomNumber, "Single") {}
-};
+inline unsigned countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned count = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline unsigned countBits(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+    unsigned count = 0;
+    for (; word != 0; word &= word - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Grows a vector of atomics (which cannot be moved) to at least count
+// entries, doubling to keep appends amortised O(1). Needs exclusive access.
+template <typename T>
+void growAtomics(std::vector<std::atomic<T>>& values, size_t count, T fill) {
+    if (count <= values.size()) {
+        return;
+    }
+    std::vector<std::atomic<T>> grown(std::max(count, values.size() * 2));
+    for (size_t i = 0; i < grown.size(); ++i) {
+        grown[i].store(i < values.size() ? values[i].load(std::memory_order_relaxed) : fill, std::memory_order_relaxed);
+    }
+    values.swap(grown);
+}
+
+// Open-addressing hash map from an ID to a position: linear probing over a
+// power-of-two table kept at most half full, so a lookup is one multiply and
+// usually one cache line regardless of how many entries there are. Entries
+// are never erased, as Hotel never removes rooms or customers.
+class IdIndex {
+    struct Slot {
+        int key;
+        uint32_t value; // EMPTY marks an unused slot
+    };
+    std::vector<Slot> slots;
+    size_t used = 0;
+
+    size_t home(int key) const {
+        uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash >> 32) & (slots.size() - 1);
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.empty() ? 16 : slots.size() * 2, Slot{0, EMPTY});
+        old.swap(slots);
+        for (const auto& slot : old) {
+            if (slot.value != EMPTY) {
+                size_t i = home(slot.key);
+                while (slots[i].value != EMPTY) {
+                    i = (i + 1) & (slots.size() - 1);
+                }
+                slots[i] = slot;
+            }
+        }
+    }
 
-class DoubleRoom : public Room {
 public:
-    DoubleRoom(int roomNumber) : Room(roomNumber, "Double") {}
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    // Adds key -> value; returns false, keeping the old value, if key is
+    // already present
+    bool insert(int key, uint32_t value) {
+        if ((used + 1) * 2 > slots.size()) {
+            grow();
+        }
+        size_t i = home(key);
+        while (slots[i].value != EMPTY) {
+            if (slots[i].key == key) {
+                return false;
+            }
+            i = (i + 1) & (slots.size() - 1);
+        }
+        slots[i] = Slot{key, value};
+        ++used;
+        return true;
+    }
+
+    // Value stored for key, or EMPTY
+    uint32_t find(int key) const {
+        if (slots.empty()) {
+            return EMPTY;
+        }
+        size_t i = home(key);
+        while (slots[i].value != EMPTY) {
+            if (slots[i].key == key) {
+                return slots[i].value;
+            }
+            i = (i + 1) & (slots.size() - 1);
+        }
+        return EMPTY;
+    }
+
+    void reserve(size_t count) {
+        while (count * 2 > slots.size()) {
+            grow();
+        }
+    }
 };
 
-class SuiteRoom : public Room {
+// Two-level bitmap over room positions: bit i of words is set when room i
+// is free, and bit w of summary is set when words[w] may be nonzero, so the
+// first free room is two ctz steps away instead of a walk over every room.
+// Words are atomic so rooms can be claimed and released concurrently; only
+// resize needs exclusive access.
+class RoomBitmap {
+    std::vector<std::atomic<uint64_t>> words;
+    std::vector<std::atomic<uint64_t>> summary;
+    std::atomic<size_t> setBits{0};
+
+    static uint64_t bitFor(size_t bit) { return uint64_t(1) << (bit % 64); }
+
 public:
-    SuiteRoom(int roomNumber) : Room(roomNumber, "Suite") {}
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    void resize(size_t bits) {
+        growAtomics<uint64_t>(words, (bits + 63) / 64, 0);
+        growAtomics<uint64_t>(summary, (words.size() + 63) / 64, 0);
+    }
+
+    bool test(size_t bit) const { return (words[bit / 64].load(std::memory_order_acquire) & bitFor(bit)) != 0; }
+    size_t count() const { return setBits.load(std::memory_order_relaxed); }
+    size_t wordCount() const { return words.size(); }
+    uint64_t word(size_t index) const { return words[index].load(std::memory_order_acquire); }
+
+    void set(size_t bit) {
+        if ((words[bit / 64].fetch_or(bitFor(bit), std::memory_order_release) & bitFor(bit)) == 0) {
+            setBits.fetch_add(1, std::memory_order_relaxed);
+        }
+        summary[bit / 4096].fetch_or(bitFor(bit / 64), std::memory_order_release);
+    }
+
+    // Atomically clears a set bit. Returns false if it was already clear.
+    bool claim(size_t bit) {
+        std::atomic<uint64_t>& word = words[bit / 64];
+        uint64_t old = word.fetch_and(~bitFor(bit), std::memory_order_acq_rel);
+        if ((old & bitFor(bit)) == 0) {
+            return false;
+        }
+        setBits.fetch_sub(1, std::memory_order_relaxed);
+        if ((old & ~bitFor(bit)) == 0) {
+            // A concurrent set() may land between the two steps, so re-mark
+            // the word if it is no longer empty
+            std::atomic<uint64_t>& hint = summary[bit / 4096];
+            hint.fetch_and(~bitFor(bit / 64), std::memory_order_acq_rel);
+            if (word.load(std::memory_order_acquire) != 0) {
+                hint.fetch_or(bitFor(bit / 64), std::memory_order_release);
+            }
+        }
+        return true;
+    }
+
+    // True if count() matches the bits and every non-empty word is marked in
+    // summary. Only meaningful while no other thread changes the bitmap.
+    bool consistent() const {
+        size_t bits = 0;
+        for (size_t w = 0; w < words.size(); ++w) {
+            uint64_t word = words[w].load(std::memory_order_acquire);
+            bits += countBits(word);
+            if (word != 0 && (summary[w / 64].load(std::memory_order_acquire) & bitFor(w)) == 0) {
+                return false;
+            }
+        }
+        return bits == count();
+    }
+
+    // Lowest set bit, or NONE. Under concurrent claims the result may
+    // already be taken, so callers claim() it and retry on failure.
+    size_t findFirst() const {
+        for (size_t s = 0; s < summary.size(); ++s) {
+            uint64_t marked = summary[s].load(std::memory_order_acquire);
+            while (marked != 0) {
+                size_t w = s * 64 + countTrailingZeros(marked);
+                uint64_t word = words[w].load(std::memory_order_acquire);
+                if (word != 0) {
+                    return w * 64 + countTrailingZeros(word);
+                }
+                marked &= marked - 1;
+            }
+        }
+        return NONE;
+    }
 };
 
 class Customer {
@@ -51,222 +491,3814 @@ class Customer {
 public:
     Customer(int id, const std::string& name) : customerID(id), name(name) {}
 
-    int getID() const { return customerID; }
-    std::string getName() const { return name; }
+    int getID() const { return customerID; }
+    std::string getName() const { return name; }
+};
+
+// Booking Class. A walk-in booking occupies the room now and has no dates;
+// a reservation holds the room for the nights [checkIn, checkOut).
+class Booking {
+    int roomNumber;
+    int customerID;
+    bool isActive;
+    bool isFinished = false; // a reservation whose stay is over, not cancelled
+    int checkIn;
+    int checkOut;
+
+public:
+    Booking(int roomNumber, int customerID, int checkIn = 0, int checkOut = 0)
+        : roomNumber(roomNumber), customerID(customerID), isActive(true), checkIn(checkIn), checkOut(checkOut) {}
+
+    int getRoomNumber() const { return roomNumber; }
+    int getCustomerID() const { return customerID; }
+    bool getStatus() const { return isActive; }
+    int getCheckIn() const { return checkIn; }
+    int getCheckOut() const { return checkOut; }
+    bool isReservation() const { return checkOut != checkIn; }
+    bool hasFinished() const { return isFinished; }
+
+    void cancelBooking() { isActive = false; }
+    void finishBooking() {
+        isActive = false;
+        isFinished = true;
+    }
+};
+
+// A block of rooms booked together by one customer. It is recorded, and
+// cancelled, as a single entry.
+class GroupBooking {
+    int groupID;
+    int customerID;
+    std::vector<int> roomNumbers;
+    bool isActive;
+
+public:
+    GroupBooking(int groupID, int customerID, std::vector<int> roomNumbers)
+        : groupID(groupID), customerID(customerID), roomNumbers(std::move(roomNumbers)), isActive(true) {}
+
+    int getID() const { return groupID; }
+    int getCustomerID() const { return customerID; }
+    const std::vector<int>& getRoomNumbers() const { return roomNumbers; }
+    bool getStatus() const { return isActive; }
+
+    void cancelBooking() { isActive = false; }
+};
+
+// Booking log that any number of threads can append to at once. Entries
+// live in fixed-size chunks that never move while bookings run. An entry is
+// visible once its state is published, and cancelling it is a CAS on that
+// state, so two cancellations of the same booking cannot both succeed.
+// sweep, which needs exclusive access, drops cancelled and finished entries
+// and closes up the gaps.
+class BookingLog {
+    enum State : uint8_t { PENDING = 0, ACTIVE = 1, CANCELED = 2 };
+    struct Entry {
+        int roomNumber;
+        int customerID;
+        int checkIn;
+        int checkOut;
+        std::atomic<uint8_t> state{PENDING};
+    };
+    static const size_t CHUNK_BITS = 16;
+    static const size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = size_t(1) << 16;
+
+    std::unique_ptr<std::atomic<Entry*>[]> chunks;
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> cancelled{0};
+
+    Entry* chunkFor(size_t index) const { return chunks[index >> CHUNK_BITS].load(std::memory_order_acquire); }
+
+public:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    // Old index -> new index of the entries a sweep kept: a bit per old
+    // entry plus a running count per 64 of them
+    class Remap {
+        std::vector<uint64_t> kept;
+        std::vector<size_t> keptBefore;
+
+    public:
+        explicit Remap(size_t entries) : kept((entries + 63) / 64), keptBefore(kept.size()) {}
+
+        void keep(size_t index) { kept[index >> 6] |= uint64_t(1) << (index & 63); }
+
+        void finish() {
+            size_t total = 0;
+            for (size_t word = 0; word < kept.size(); ++word) {
+                keptBefore[word] = total;
+                total += countBits(kept[word]);
+            }
+        }
+
+        bool contains(size_t index) const { return (kept[index >> 6] >> (index & 63)) & 1; }
+
+        size_t operator()(size_t index) const {
+            return keptBefore[index >> 6] + countBits(kept[index >> 6] & ((uint64_t(1) << (index & 63)) - 1));
+        }
+    };
+
+    BookingLog() : chunks(new std::atomic<Entry*>[MAX_CHUNKS]()) {}
+    BookingLog(const BookingLog&) = delete;
+    BookingLog& operator=(const BookingLog&) = delete;
+
+    ~BookingLog() {
+        for (size_t chunk = 0; chunk < MAX_CHUNKS; ++chunk) {
+            delete[] chunks[chunk].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Upper bound on the number of entries (including ones still being written)
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    size_t cancelledCount() const { return cancelled.load(std::memory_order_relaxed); }
+
+    size_t append(const Booking& booking) {
+        size_t index = count.fetch_add(1, std::memory_order_acq_rel);
+        size_t chunk = index >> CHUNK_BITS;
+        if (chunk >= MAX_CHUNKS) {
+            throw std::length_error("Booking log is full.");
+        }
+        Entry* entries = chunks[chunk].load(std::memory_order_acquire);
+        if (entries == nullptr) {
+            Entry* fresh = new Entry[CHUNK_SIZE];
+            if (chunks[chunk].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel)) {
+                entries = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        Entry& entry = entries[index & (CHUNK_SIZE - 1)];
+        entry.roomNumber = booking.getRoomNumber();
+        entry.customerID = booking.getCustomerID();
+        entry.checkIn = booking.getCheckIn();
+        entry.checkOut = booking.getCheckOut();
+        if (!booking.getStatus()) {
+            cancelled.fetch_add(1, std::memory_order_relaxed);
+        }
+        entry.state.store(booking.getStatus() ? ACTIVE : CANCELED, std::memory_order_release);
+        return index;
+    }
+
+    // Calls visit(booking) for every published entry, oldest first
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        size_t end = size();
+        for (size_t index = 0; index < end; ++index) {
+            Entry* entries = chunkFor(index);
+            if (entries == nullptr) {
+                continue;
+            }
+            const Entry& entry = entries[index & (CHUNK_SIZE - 1)];
+            uint8_t state = entry.state.load(std::memory_order_acquire);
+            if (state == PENDING) {
+                continue;
+            }
+            Booking booking(entry.roomNumber, entry.customerID, entry.checkIn, entry.checkOut);
+            if (state == CANCELED) {
+                booking.cancelBooking();
+            }
+            visit(booking);
+        }
+    }
+
+    // Cancels the booking at index if it is active and accepted by match
+    template <typename Match>
+    bool cancelAt(size_t index, Match match) {
+        if (index >= size() || chunkFor(index) == nullptr) {
+            return false;
+        }
+        Entry& entry = chunkFor(index)[index & (CHUNK_SIZE - 1)];
+        uint8_t expected = ACTIVE;
+        if (entry.state.load(std::memory_order_acquire) == ACTIVE
+            && match(Booking(entry.roomNumber, entry.customerID, entry.checkIn, entry.checkOut))
+            && entry.state.compare_exchange_strong(expected, CANCELED, std::memory_order_acq_rel)) {
+            cancelled.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // Hands every cancelled entry, and every active one finished(booking)
+    // accepts (marked finished), to spill, oldest first, and moves the rest
+    // down over the gaps, keeping their order; chunks left empty are freed.
+    // Needs exclusive access. Returns where each kept entry went.
+    template <typename Finished, typename Spill>
+    Remap sweep(Finished finished, Spill spill) {
+        size_t end = size();
+        Remap remap(end);
+        size_t kept = 0;
+        for (size_t index = 0; index < end; ++index) {
+            Entry* entries = chunkFor(index);
+            if (entries == nullptr) {
+                continue;
+            }
+            Entry& entry = entries[index & (CHUNK_SIZE - 1)];
+            uint8_t state = entry.state.load(std::memory_order_relaxed);
+            if (state == PENDING) {
+                continue;
+            }
+            Booking booking(entry.roomNumber, entry.customerID, entry.checkIn, entry.checkOut);
+            if (state == CANCELED) {
+                booking.cancelBooking();
+                spill(booking);
+                continue;
+            }
+            if (finished(booking)) {
+                booking.finishBooking();
+                spill(booking);
+                continue;
+            }
+            remap.keep(index);
+            Entry& target = chunkFor(kept)[kept & (CHUNK_SIZE - 1)];
+            target.roomNumber = entry.roomNumber;
+            target.customerID = entry.customerID;
+            target.checkIn = entry.checkIn;
+            target.checkOut = entry.checkOut;
+            target.state.store(ACTIVE, std::memory_order_relaxed);
+            ++kept;
+        }
+        remap.finish();
+
+        size_t usedChunks = (kept + CHUNK_SIZE - 1) >> CHUNK_BITS;
+        if (Entry* last = kept % CHUNK_SIZE != 0 ? chunkFor(kept) : nullptr) {
+            for (size_t i = kept % CHUNK_SIZE; i < CHUNK_SIZE; ++i) {
+                last[i].state.store(PENDING, std::memory_order_relaxed);
+            }
+        }
+        for (size_t chunk = usedChunks; chunk <= (end >> CHUNK_BITS) && chunk < MAX_CHUNKS; ++chunk) {
+            delete[] chunks[chunk].exchange(nullptr, std::memory_order_relaxed);
+        }
+        count.store(kept, std::memory_order_release);
+        cancelled.store(0, std::memory_order_relaxed);
+        return remap;
+    }
+};
+
+
+// Cancelled and finished bookings moved out of BookingLog, compressed.
+// Entries are packed into chunks of CHUNK_BOOKINGS; each field is stored as
+// a zigzag varint of its difference from the previous entry's, restarting
+// every chunk so a chunk decodes on its own. A booking takes a few bytes instead
+// of a log entry's 20, and nothing here is read on the booking path.
+class BookingArchive {
+    static const size_t CHUNK_BOOKINGS = 4096;
+    struct Chunk {
+        std::vector<uint8_t> bytes;
+        size_t count = 0;
+    };
+    std::vector<Chunk> chunks;
+    size_t total = 0;
+    int lastRoom = 0;     // fields of the newest entry, which the next
+    int lastCustomer = 0; // one is encoded against
+    int lastCheckIn = 0;
+
+    static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        for (; value >= 0x80; value >>= 7) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint64_t getVarint(const uint8_t*& in) {
+        uint64_t value = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            uint8_t byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+    }
+
+    // Maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ... so small differences of
+    // either sign stay short
+    static uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Kept in the low two bits of the last field
+    enum Status : uint8_t { CANCELED = 0, ACTIVE = 1, FINISHED = 2 };
+
+    static uint64_t statusOf(const Booking& booking) {
+        return booking.getStatus() ? ACTIVE : booking.hasFinished() ? FINISHED : CANCELED;
+    }
+
+public:
+    size_t size() const { return total; }
+
+    // Heap bytes held
+    size_t byteSize() const {
+        size_t bytes = chunks.capacity() * sizeof(Chunk);
+        for (const auto& chunk : chunks) {
+            bytes += chunk.bytes.capacity();
+        }
+        return bytes;
+    }
+
+    void append(const Booking& booking) {
+        if (chunks.empty() || chunks.back().count == CHUNK_BOOKINGS) {
+            if (!chunks.empty()) {
+                chunks.back().bytes.shrink_to_fit();
+            }
+            chunks.emplace_back();
+            lastRoom = lastCustomer = lastCheckIn = 0;
+        }
+        Chunk& chunk = chunks.back();
+        putVarint(chunk.bytes, zigzag(static_cast<int64_t>(booking.getRoomNumber()) - lastRoom));
+        putVarint(chunk.bytes, zigzag(static_cast<int64_t>(booking.getCustomerID()) - lastCustomer));
+        putVarint(chunk.bytes, zigzag(static_cast<int64_t>(booking.getCheckIn()) - lastCheckIn));
+        int64_t nights = static_cast<int64_t>(booking.getCheckOut()) - booking.getCheckIn();
+        putVarint(chunk.bytes, zigzag(nights) << 2 | statusOf(booking));
+        lastRoom = booking.getRoomNumber();
+        lastCustomer = booking.getCustomerID();
+        lastCheckIn = booking.getCheckIn();
+        ++chunk.count;
+        ++total;
+    }
+
+    // Calls visit(booking) for every entry, oldest first
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const auto& chunk : chunks) {
+            const uint8_t* in = chunk.bytes.data();
+            int64_t room = 0, customer = 0, checkIn = 0;
+            for (size_t i = 0; i < chunk.count; ++i) {
+                room += unzigzag(getVarint(in));
+                customer += unzigzag(getVarint(in));
+                checkIn += unzigzag(getVarint(in));
+                uint64_t last = getVarint(in);
+                Booking booking(static_cast<int>(room), static_cast<int>(customer), static_cast<int>(checkIn),
+                                static_cast<int>(checkIn + unzigzag(last >> 2)));
+                if ((last & 3) == CANCELED) {
+                    booking.cancelBooking();
+                } else if ((last & 3) == FINISHED) {
+                    booking.finishBooking();
+                }
+                visit(booking);
+            }
+        }
+    }
+};
+
+// Columnar copy of booking history for reports: one array per field, so a
+// kernel reads only the columns it needs and walks them sequentially. Rows
+// are appended by Hotel as bookings happen and never removed; a cancelled
+// row stays with CANCELED status. Columns live in fixed-size blocks that
+// never move, like BookingLog's chunks, so a report can scan the first
+// rows while more are appended: writers are serialised by Hotel's
+// analyticsMutex, which a report only holds to read size(). Only status
+// and checkOut change after a row is added, and those are atomic.
+class BookingAnalytics {
+public:
+    enum Status : uint8_t { ACTIVE = 1, CANCELED = 2 };
+    static constexpr int32_t OPEN_STAY = INT32_MAX; // checkOut of a walk-in still in the room
+    static constexpr size_t BLOCK_BITS = 16;
+    static constexpr size_t ROW_BLOCK = size_t(1) << BLOCK_BITS; // rows per column block
+    static constexpr size_t MAX_BLOCKS = size_t(1) << 16;
+    static constexpr size_t SLICE_BLOCKS = 16; // fewest blocks worth a thread of their own
+    static constexpr size_t NO_ROW = static_cast<size_t>(-1);
+
+    // Occupied room-nights and revenue (in cents) per room type per day
+    struct DailyOccupancy {
+        int firstDay = 0;
+        size_t days = 0;
+        std::array<std::vector<int64_t>, ROOM_TYPE_COUNT> occupied;
+        std::array<std::vector<int64_t>, ROOM_TYPE_COUNT> revenue;
+    };
+
+    // Bookings checking in within a window, and how many were cancelled
+    struct CancellationCounts {
+        std::array<uint64_t, ROOM_TYPE_COUNT> bookings{};
+        std::array<uint64_t, ROOM_TYPE_COUNT> cancelled{};
+    };
+
+private:
+    struct Block {
+        int32_t roomNumbers[ROW_BLOCK];
+        int32_t customerIDs[ROW_BLOCK];
+        uint8_t roomTypes[ROW_BLOCK];
+        std::atomic<uint8_t> statuses[ROW_BLOCK];
+        int32_t checkIns[ROW_BLOCK];
+        std::atomic<int32_t> checkOuts[ROW_BLOCK];
+        int32_t rates[ROW_BLOCK]; // cents per night
+    };
+
+    std::unique_ptr<std::atomic<Block*>[]> blocks;
+    size_t rows = 0;
+
+    Block& blockFor(size_t row) const { return *blocks[row >> BLOCK_BITS].load(std::memory_order_acquire); }
+
+    // Runs kernel(block, count, part) over the first count rows of each of
+    // the blocks holding rows [0, end), in contiguous runs of blocks, one
+    // per thread, and returns the per-thread results for the caller to merge
+    template <typename Part, typename Kernel>
+    std::vector<Part> forSlices(size_t end, size_t threads, const Part& empty, Kernel kernel) const {
+        size_t blockCount = (end + ROW_BLOCK - 1) / ROW_BLOCK;
+        threads = std::max<size_t>(1, std::min(threads, (blockCount + SLICE_BLOCKS - 1) / SLICE_BLOCKS));
+        std::vector<Part> parts(threads, empty);
+        auto run = [&](size_t t) {
+            for (size_t block = blockCount * t / threads; block < blockCount * (t + 1) / threads; ++block) {
+                kernel(blockFor(block * ROW_BLOCK), std::min(ROW_BLOCK, end - block * ROW_BLOCK), parts[t]);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(run, t);
+        }
+        run(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return parts;
+    }
+
+public:
+    BookingAnalytics() : blocks(new std::atomic<Block*>[MAX_BLOCKS]()) {}
+    BookingAnalytics(const BookingAnalytics&) = delete;
+    BookingAnalytics& operator=(const BookingAnalytics&) = delete;
+
+    ~BookingAnalytics() {
+        for (size_t block = 0; block < MAX_BLOCKS; ++block) {
+            delete blocks[block].load(std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return rows; }
+
+    // Adds a stay of the nights [checkIn, checkOut) and returns its row
+    size_t add(int roomNumber, int customerID, RoomType roomType, int checkIn, int checkOut, int32_t rate) {
+        size_t row = rows;
+        size_t block = row >> BLOCK_BITS;
+        if (block >= MAX_BLOCKS) {
+            throw std::length_error("Booking analytics is full.");
+        }
+        if (blocks[block].load(std::memory_order_relaxed) == nullptr) {
+            blocks[block].store(new Block, std::memory_order_release);
+        }
+        Block& columns = blockFor(row);
+        size_t i = row & (ROW_BLOCK - 1);
+        columns.roomNumbers[i] = roomNumber;
+        columns.customerIDs[i] = customerID;
+        columns.roomTypes[i] = static_cast<uint8_t>(roomType);
+        columns.statuses[i].store(ACTIVE, std::memory_order_relaxed);
+        columns.checkIns[i] = checkIn;
+        columns.checkOuts[i].store(checkOut, std::memory_order_relaxed);
+        columns.rates[i] = rate;
+        return rows++;
+    }
+
+    void cancel(size_t row) { blockFor(row).statuses[row & (ROW_BLOCK - 1)].store(CANCELED, std::memory_order_relaxed); }
+
+    // Ends an open walk-in on day: a guest who leaves on the day they
+    // arrived counts as a cancellation, anyone else as a completed stay
+    void checkOut(size_t row, int day) {
+        Block& columns = blockFor(row);
+        size_t i = row & (ROW_BLOCK - 1);
+        if (day > columns.checkIns[i]) {
+            columns.checkOuts[i].store(day, std::memory_order_relaxed);
+        } else {
+            columns.statuses[i].store(CANCELED, std::memory_order_relaxed);
+        }
+    }
+
+    // Active stays among rows [0, end) clipped to [firstDay, firstDay +
+    // days), with open stays taken to end on openUntil. Each row adds
+    // +1/-1 (and +rate/-rate) at the ends of its stay in a per-thread
+    // difference array, without branching, and a prefix sum turns the
+    // merged arrays into per-day totals, so the cost is one pass over five
+    // columns however long the stays are.
+    DailyOccupancy dailyOccupancy(size_t end, int firstDay, size_t days, int openUntil, size_t threads) const {
+        struct Part {
+            std::vector<int64_t> nights;  // [type * (days + 1) + day]
+            std::vector<int64_t> revenue;
+        };
+        const size_t stride = days + 1;
+        const int64_t lastDay = static_cast<int64_t>(firstDay) + static_cast<int64_t>(days);
+        Part empty{std::vector<int64_t>(ROOM_TYPE_COUNT * stride), std::vector<int64_t>(ROOM_TYPE_COUNT * stride)};
+        std::vector<Part> parts = forSlices(end, threads, empty, [&](const Block& columns, size_t count, Part& part) {
+            for (size_t i = 0; i < count; ++i) {
+                int32_t checkOut = columns.checkOuts[i].load(std::memory_order_relaxed);
+                int64_t from = std::max<int64_t>(columns.checkIns[i], firstDay);
+                int64_t to = std::min<int64_t>(checkOut == OPEN_STAY ? openUntil : checkOut, lastDay);
+                int64_t counted = (columns.statuses[i].load(std::memory_order_relaxed) == ACTIVE) & (from < to);
+                size_t base = columns.roomTypes[i] * stride;
+                size_t start = static_cast<size_t>(counted * (from - firstDay));
+                size_t stop = static_cast<size_t>(counted * (to - firstDay));
+                part.nights[base + start] += counted;
+                part.nights[base + stop] -= counted;
+                part.revenue[base + start] += counted * columns.rates[i];
+                part.revenue[base + stop] -= counted * columns.rates[i];
+            }
+        });
+
+        DailyOccupancy result;
+        result.firstDay = firstDay;
+        result.days = days;
+        for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+            result.occupied[type].resize(days);
+            result.revenue[type].resize(days);
+            int64_t nights = 0, revenue = 0;
+            for (size_t day = 0; day < days; ++day) {
+                for (const auto& part : parts) {
+                    nights += part.nights[type * stride + day];
+                    revenue += part.revenue[type * stride + day];
+                }
+                result.occupied[type][day] = nights;
+                result.revenue[type][day] = revenue;
+            }
+        }
+        return result;
+    }
+
+    // Counts, per room type, the bookings among rows [0, end) checking in
+    // within [firstDay, lastDay) and the cancelled ones among them. With
+    // SSE2 four rows are compared at once into 32-bit lane counters,
+    // flushed every block.
+    CancellationCounts cancellations(size_t end, int firstDay, int lastDay, size_t threads) const {
+        std::vector<CancellationCounts> parts = forSlices(end, threads, CancellationCounts(),
+                                                          [&](const Block& columns, size_t count, CancellationCounts& part) {
+            size_t i = 0;
+#ifdef __SSE2__
+            const __m128i afterStart = _mm_set1_epi32(firstDay - 1);
+            const __m128i beforeEnd = _mm_set1_epi32(lastDay);
+            const __m128i canceled = _mm_set1_epi32(CANCELED);
+            __m128i booked[ROOM_TYPE_COUNT], dropped[ROOM_TYPE_COUNT], typeTags[ROOM_TYPE_COUNT];
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                booked[type] = dropped[type] = _mm_setzero_si128();
+                typeTags[type] = _mm_set1_epi32(static_cast<int>(type));
+            }
+            for (; i + 4 <= count; i += 4) {
+                __m128i day = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&columns.checkIns[i]));
+                __m128i inWindow = _mm_and_si128(_mm_cmpgt_epi32(day, afterStart), _mm_cmplt_epi32(day, beforeEnd));
+                int32_t typeBytes;
+                std::memcpy(&typeBytes, &columns.roomTypes[i], 4);
+                const __m128i zero = _mm_setzero_si128();
+                __m128i types = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(typeBytes), zero), zero);
+                // Statuses may be changing underneath, so each is read atomically
+                __m128i status = _mm_setr_epi32(columns.statuses[i].load(std::memory_order_relaxed),
+                                                columns.statuses[i + 1].load(std::memory_order_relaxed),
+                                                columns.statuses[i + 2].load(std::memory_order_relaxed),
+                                                columns.statuses[i + 3].load(std::memory_order_relaxed));
+                __m128i isCanceled = _mm_cmpeq_epi32(status, canceled);
+                for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                    // Masks are -1 where true, so subtracting counts them
+                    __m128i match = _mm_and_si128(inWindow, _mm_cmpeq_epi32(types, typeTags[type]));
+                    booked[type] = _mm_sub_epi32(booked[type], match);
+                    dropped[type] = _mm_sub_epi32(dropped[type], _mm_and_si128(match, isCanceled));
+                }
+            }
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                alignas(16) uint32_t lanes[8];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), booked[type]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes + 4), dropped[type]);
+                part.bookings[type] += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+                part.cancelled[type] += uint64_t(lanes[4]) + lanes[5] + lanes[6] + lanes[7];
+            }
+#endif
+            for (; i < count; ++i) {
+                bool inWindow = columns.checkIns[i] >= firstDay && columns.checkIns[i] < lastDay;
+                part.bookings[columns.roomTypes[i]] += inWindow;
+                part.cancelled[columns.roomTypes[i]] += inWindow
+                    && columns.statuses[i].load(std::memory_order_relaxed) == CANCELED;
+            }
+        });
+
+        CancellationCounts result;
+        for (const auto& part : parts) {
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                result.bookings[type] += part.bookings[type];
+                result.cancelled[type] += part.cancelled[type];
+            }
+        }
+        return result;
+    }
+};
+
+// Nightly rate of each room type in cents, recorded with every stay
+const std::array<int32_t, ROOM_TYPE_COUNT> NIGHTLY_RATES = {8000, 12000, 25000};
+
+// What Hotel::getReport returns: BookingAnalytics results plus the room
+// counts the rates are taken over
+struct BookingReport {
+    BookingAnalytics::DailyOccupancy occupancy;
+    BookingAnalytics::CancellationCounts cancellations;
+    std::array<size_t, ROOM_TYPE_COUNT> rooms{};
+};
+
+// Unbuffered file helpers for the journal and snapshot
+inline int openForAppend(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+inline bool writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1 << 30)));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+inline bool syncToDisk(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+inline bool truncateTo(int fd, uint64_t size) {
+#ifdef _WIN32
+    return _chsize_s(fd, static_cast<__int64>(size)) == 0;
+#else
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+inline void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// Moves source over target; a crash leaves one or the other
+inline bool renameOver(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    std::remove(target.c_str());
+#endif
+    return std::rename(source.c_str(), target.c_str()) == 0;
+}
+
+// Flushes a finished temporary file to disk and moves it over the target
+inline bool replaceFile(const std::string& temporary, const std::string& target) {
+    int fd = openForAppend(temporary);
+    bool synced = fd >= 0 && syncToDisk(fd);
+    if (fd >= 0) {
+        closeFile(fd);
+    }
+    return synced && renameOver(temporary, target);
+}
+
+inline bool readFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(data.data(), static_cast<std::streamsize>(data.size())));
+}
+
+// 32-bit FNV-1a; catches torn and corrupt journal records
+inline uint32_t recordChecksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+// Append-only log of Hotel mutations made since the snapshot it extends.
+// The file starts with a magic and the generation of that snapshot; each
+// record is
+//   uint32 length | uint8 type | payload | uint32 checksum
+// where length and checksum cover type and payload. append() only queues a
+// record: a dedicated writer thread writes and fsyncs whatever has queued
+// up as one batch, so callers never wait for the disk. A crash can lose the
+// batch in flight; sync() waits until everything queued is on disk. A
+// failed batch is cut back off the file and leaves the journal failed,
+// dropping every later record, until reset() starts a new one.
+//
+// rotate() seals the file as <path>.sealed, ending it with a ROTATE record
+// that names the generation of the new file, so the sealed part can be
+// folded into a snapshot while new records keep arriving.
+class Journal {
+public:
+    enum RecordType : uint8_t {
+        ADD_ROOM = 1,
+        ADD_CUSTOMER = 2,
+        BOOK = 3,
+        CANCEL = 4,
+        RESERVE = 5,
+        CANCEL_RESERVATION = 6,
+        BOOK_GROUP = 7,
+        CANCEL_GROUP = 8,
+        ROTATE = 9
+    };
+
+    class Record {
+    private:
+        std::vector<char> bytes;
+
+    public:
+        explicit Record(RecordType type) {
+            bytes.reserve(64);
+            bytes.assign(sizeof(uint32_t), 0); // length, filled in by finish()
+            bytes.push_back(static_cast<char>(type));
+        }
+
+        Record& putInt(int32_t value) {
+            const char* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(value));
+            return *this;
+        }
+
+        Record& putString(std::string_view text) {
+            putInt(static_cast<int32_t>(text.size()));
+            bytes.insert(bytes.end(), text.begin(), text.end());
+            return *this;
+        }
+
+        // Fills in the length prefix and checksum; returns the encoded record
+        const std::vector<char>& finish() {
+            uint32_t length = static_cast<uint32_t>(bytes.size() - sizeof(uint32_t));
+            std::memcpy(bytes.data(), &length, sizeof(length));
+            uint32_t checksum = recordChecksum(bytes.data() + sizeof(uint32_t), length);
+            const char* raw = reinterpret_cast<const char*>(&checksum);
+            bytes.insert(bytes.end(), raw, raw + sizeof(checksum));
+            return bytes;
+        }
+    };
+
+    class Cursor {
+    private:
+        const char* pos;
+        const char* end;
+
+    public:
+        Cursor(const char* data, size_t size) : pos(data), end(data + size) {}
+
+        bool getInt(int32_t& value) {
+            if (end - pos < static_cast<std::ptrdiff_t>(sizeof(value))) {
+                return false;
+            }
+            std::memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        }
+
+        bool getString(std::string_view& text) {
+            int32_t length;
+            if (!getInt(length) || length < 0 || end - pos < length) {
+                return false;
+            }
+            text = std::string_view(pos, static_cast<size_t>(length));
+            pos += length;
+            return true;
+        }
+    };
+
+private:
+    static constexpr char MAGIC[8] = {'H', 'T', 'L', 'J', 'R', 'N', 'L', '\0'};
+    static const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint32_t);
+
+    std::string path;
+    bool open = false;
+    int fd = -1; // only the writer thread touches it once that is running
+    uint32_t generation = 0;
+    std::atomic<size_t> recordCount{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;    // tells the writer there is work or it should stop
+    std::condition_variable written; // tells callers a batch is on disk
+    std::vector<char> pending;       // records for the current file
+    std::vector<char> sealing;       // records that end the file being sealed
+    uint64_t appendedSeq = 0;
+    uint64_t durableSeq = 0;
+    uint64_t sealSeq = 0; // sequence number of the ROTATE record in sealing
+    uint64_t durableLength = 0; // bytes of the file known to be on disk; writer only
+    bool writing = false;
+    bool stopping = false;
+    std::atomic<bool> failed{false};
+    std::thread writer;
+
+    // Calls visit(type, payload, size) for each intact record and returns the
+    // byte length of the valid prefix; a torn or corrupt tail ends the scan.
+    template <typename Visit>
+    static size_t scan(const char* data, size_t size, Visit visit) {
+        size_t pos = HEADER_SIZE;
+        while (size - pos >= 2 * sizeof(uint32_t)) {
+            uint32_t length, checksum;
+            std::memcpy(&length, data + pos, sizeof(length));
+            if (length == 0 || size - pos - 2 * sizeof(uint32_t) < length) {
+                break;
+            }
+            const char* body = data + pos + sizeof(uint32_t);
+            std::memcpy(&checksum, body + length, sizeof(checksum));
+            if (recordChecksum(body, length) != checksum) {
+                break;
+            }
+            visit(static_cast<uint8_t>(body[0]), body + 1, length - 1);
+            pos += length + 2 * sizeof(uint32_t);
+        }
+        return pos;
+    }
+
+    static bool hasHeader(const std::vector<char>& data, uint32_t& fileGeneration) {
+        if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+        std::memcpy(&fileGeneration, data.data() + sizeof(MAGIC), sizeof(fileGeneration));
+        return true;
+    }
+
+    static bool writeHeader(int file, uint32_t fileGeneration) {
+        char header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        std::memcpy(header + sizeof(MAGIC), &fileGeneration, sizeof(fileGeneration));
+        return truncateTo(file, 0) && writeFully(file, header, sizeof(header)) && syncToDisk(file);
+    }
+
+    // Closes the finished file, moves it aside and starts the next one
+    bool sealFile(uint32_t nextGeneration) {
+        closeFile(fd);
+        bool moved = renameOver(path, getSealedPath());
+        fd = openForAppend(path);
+        if (!moved || fd < 0 || !writeHeader(fd, nextGeneration)) {
+            return false;
+        }
+        durableLength = HEADER_SIZE;
+        return true;
+    }
+
+    void writeLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !pending.empty() || !sealing.empty(); });
+            if (pending.empty() && sealing.empty()) {
+                return;
+            }
+            // Records queued before a rotation go to the old file first
+            bool seal = !sealing.empty();
+            std::vector<char> batch;
+            batch.swap(seal ? sealing : pending);
+            uint64_t batchSeq = seal ? sealSeq : appendedSeq;
+            uint32_t nextGeneration = generation;
+            writing = true;
+            lock.unlock();
+            bool ok = writeFully(fd, batch.data(), batch.size()) && syncToDisk(fd);
+            if (ok) {
+                durableLength += batch.size();
+                if (seal) {
+                    ok = sealFile(nextGeneration);
+                }
+            } else {
+                // A torn record would hide everything appended after it
+                truncateTo(fd, durableLength);
+            }
+            lock.lock();
+            writing = false;
+            if (ok) {
+                durableSeq = std::max(durableSeq, batchSeq);
+            } else {
+                std::cerr << "Warning: failed to write " << path << "; changes are no longer journaled.\n";
+                failed.store(true, std::memory_order_release);
+                pending.clear();
+                sealing.clear();
+            }
+            written.notify_all();
+        }
+    }
+
+public:
+    explicit Journal(std::string journalPath) : path(std::move(journalPath)) {
+        size_t validLength = 0;
+        std::vector<char> existing;
+        if (readFile(path, existing) && hasHeader(existing, generation)) {
+            validLength = scan(existing.data(), existing.size(), [this](uint8_t, const char*, size_t) { ++recordCount; });
+            if (validLength < existing.size()) {
+                std::cerr << "Warning: discarding a torn record at the end of " << path << ".\n";
+            }
+        }
+        fd = openForAppend(path);
+        if (fd < 0) {
+            std::cerr << "Warning: cannot open " << path << "; changes will not be journaled.\n";
+            return;
+        }
+        if (validLength == 0) {
+            failed = !writeHeader(fd, generation);
+            durableLength = HEADER_SIZE;
+        } else {
+            failed = !truncateTo(fd, validLength);
+            durableLength = validLength;
+        }
+        open = true;
+        writer = std::thread([this] { writeLoop(); });
+    }
+
+    // Writes out everything still queued before closing
+    ~Journal() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (writer.joinable()) {
+            writer.join();
+        }
+        if (fd >= 0) {
+            closeFile(fd);
+        }
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    const std::string& getPath() const { return path; }
+    std::string getSealedPath() const { return path + ".sealed"; }
+    uint32_t getGeneration() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return generation;
+    }
+    size_t getRecordCount() const { return recordCount; }
+    bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+
+    // Queues a record for the writer thread and returns its sequence
+    // number. Once the journal has failed the record is dropped.
+    uint64_t append(Record& record) {
+        if (!open) {
+            return 0;
+        }
+        const std::vector<char>& bytes = record.finish();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed.load(std::memory_order_relaxed)) {
+            pending.insert(pending.end(), bytes.begin(), bytes.end());
+            ++recordCount;
+            wake.notify_one();
+        }
+        return ++appendedSeq;
+    }
+
+    // Waits until every record queued so far is on disk; false if a batch
+    // failed and some never will be
+    bool sync() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t target = appendedSeq;
+        written.wait(lock, [&] { return durableSeq >= target || failed.load(std::memory_order_relaxed); });
+        return durableSeq >= target;
+    }
+
+    // Seals everything queued so far, followed by a ROTATE record naming
+    // nextGeneration, into <path>.sealed and starts a new file for
+    // nextGeneration. Once that is on disk, returns true and the generation
+    // of the sealed file through sealedGeneration; false if the journal
+    // failed. Appends carry on meanwhile and go to the new file.
+    bool rotate(uint32_t nextGeneration, uint32_t& sealedGeneration) {
+        Record marker(ROTATE);
+        marker.putInt(static_cast<int32_t>(nextGeneration));
+        const std::vector<char>& bytes = marker.finish();
+        std::unique_lock<std::mutex> lock(mutex);
+        sealedGeneration = generation;
+        if (!open || failed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        pending.insert(pending.end(), bytes.begin(), bytes.end());
+        sealing.swap(pending);
+        sealSeq = ++appendedSeq;
+        generation = nextGeneration;
+        recordCount = 0;
+        wake.notify_one();
+        uint64_t target = sealSeq;
+        written.wait(lock, [&] { return durableSeq >= target || failed.load(std::memory_order_relaxed); });
+        return durableSeq >= target;
+    }
+
+    // Starts an empty journal on top of a new snapshot once the writer has
+    // caught up. With keepOld the previous journal is first copied aside to
+    // <path>.old. Callers must stop appends meanwhile.
+    void reset(uint32_t newGeneration, bool keepOld = false) {
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return !writing && pending.empty() && sealing.empty(); });
+        if (!open) {
+            return;
+        }
+        if (keepOld && recordCount > 0) {
+            std::vector<char> old;
+            std::ofstream backup(path + ".old", std::ios::binary);
+            if (readFile(path, old)) {
+                backup.write(old.data(), static_cast<std::streamsize>(old.size()));
+            }
+        }
+        generation = newGeneration;
+        recordCount = 0;
+        if (fd < 0) {
+            fd = openForAppend(path); // a failed seal may have lost it
+        }
+        if (fd >= 0 && writeHeader(fd, generation)) {
+            durableLength = HEADER_SIZE;
+            failed.store(false, std::memory_order_release);
+        } else {
+            std::cerr << "Warning: failed to reset " << path << ".\n";
+            failed.store(true, std::memory_order_release);
+        }
+    }
+
+    // Calls apply(type, Cursor) for every intact record of the journal file
+    // at file, oldest first, provided it extends baseGeneration. Returns the
+    // number of records applied.
+    template <typename Apply>
+    static size_t replay(const std::string& file, uint32_t baseGeneration, Apply apply) {
+        std::vector<char> data;
+        uint32_t fileGeneration;
+        if (!readFile(file, data) || !hasHeader(data, fileGeneration) || fileGeneration != baseGeneration) {
+            return 0;
+        }
+        size_t applied = 0;
+        scan(data.data(), data.size(), [&](uint8_t type, const char* payload, size_t size) {
+            apply(type, Cursor(payload, size));
+            ++applied;
+        });
+        return applied;
+    }
+};
+
+// Outcome of the non-throwing Hotel::try* operations
+enum class BookingStatus : uint8_t { Ok, CustomerNotFound, CustomerExists, RoomNotFound, RoomExists,
+                                     RoomUnavailable, NoFreeRoom, NoActiveBooking, GroupBooked,
+                                     PropertyNotFound, NotJournaled };
+
+inline const char* describe(BookingStatus status) {
+    switch (status) {
+    case BookingStatus::Ok:
+        return "OK.";
+    case BookingStatus::CustomerNotFound:
+        return "Customer not found.";
+    case BookingStatus::CustomerExists:
+        return "Customer ID already exists.";
+    case BookingStatus::RoomNotFound:
+        return "Room not found.";
+    case BookingStatus::RoomExists:
+        return "Room number already exists.";
+    case BookingStatus::RoomUnavailable:
+        return "Room is not available.";
+    case BookingStatus::NoFreeRoom:
+        return "No room of that type is available.";
+    case BookingStatus::NoActiveBooking:
+        return "Booking not found or already canceled.";
+    case BookingStatus::GroupBooked:
+        return "Room is part of a group booking; cancel the group instead.";
+    case BookingStatus::PropertyNotFound:
+        return "Property not found.";
+    case BookingStatus::NotJournaled:
+        return "Changes can no longer be written to the journal; save the hotel to keep them.";
+    }
+    return "Unknown status.";
+}
+
+// Free and booked rooms of one type, from Hotel::getOccupancy
+struct RoomTypeOccupancy {
+    size_t available = 0;
+    size_t occupied = 0;
+};
+
+// Which rooms Hotel::listRooms returns
+struct RoomFilter {
+    bool allTypes = true;
+    RoomType roomType = RoomType::Single; // used when allTypes is false
+    bool availableOnly = false;
+};
+
+// One page of rooms, with their current availability
+struct RoomPage {
+    std::vector<Room> rooms;
+    size_t totalMatches = 0;
+};
+
+// Hotel Class. bookRoom, bookAnyRoom, cancelBooking and the queries are safe
+// to call from many threads at once: they hold catalogMutex shared, claim
+// and release rooms with atomic bit operations and append to a concurrent
+// log. Adding rooms or customers, reservations and save/load hold it
+// exclusively. Every change is also journaled (see Journal), so the state
+// survives a restart without an explicit save.
+class Hotel {
+    std::vector<Room> rooms;
+    std::vector<Customer> customers;
+
+    // Bookings that can still be cancelled live in bookings; cancelled ones
+    // and reservations whose check-out day has passed are swept into
+    // archive (see archiveBookings), which only history queries and saves
+    // read. lastSweepDay is the day of the last sweep.
+    BookingLog bookings;
+    BookingArchive archive;
+    int lastSweepDay = 0;
+
+    // Free rooms of each type by position. This is the live availability of
+    // every room; the flag inside rooms[i] only records how it was added.
+    std::array<RoomBitmap, ROOM_TYPE_COUNT> freeRooms;
+
+    // Log index of each room's active walk-in booking, or BookingLog::NONE.
+    // A room has at most one, since booking it means claiming its free bit,
+    // so cancelBooking finds it without scanning the log. Rooms held by a
+    // group booking store GROUP_TAG | index into groups instead.
+    std::vector<std::atomic<size_t>> walkIns;
+    static const size_t GROUP_TAG = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    // Group bookings in ID order (ID = position + 1), guarded by groupMutex
+    std::vector<GroupBooking> groups;
+    std::mutex groupMutex;
+
+    mutable std::shared_mutex catalogMutex;
+
+    // When false, successful bookings and cancellations are silent
+    bool verbose = true;
+
+    // Every change is queued on the journal before other threads can act on
+    // it (before a room is released, or its booking published), so the
+    // journal order agrees with the order the changes took effect in. Rooms
+    // are journaled by position, which snapshots preserve, because
+    // bookAnyRoom may pick a room whose number another room shares. Null in
+    // the scratch copy a compaction loads into; replaying suppresses it.
+    std::unique_ptr<Journal> journal;
+    bool replaying = false;
+
+    // The journal files on disk extend whatever an earlier session loaded or
+    // saved, not this hotel, until loadData or saveData ties them together;
+    // see attachJournal
+    std::atomic<bool> journalAttached{false};
+    std::mutex attachMutex;
+
+    // Background compaction: once the journal is due, compactLoop seals it
+    // and folds it into a new snapshot. compactMutex is held for a whole
+    // compaction, and by save and load so they never overlap one.
+    std::thread compactor;
+    std::mutex compactMutex;
+    std::mutex compactWakeMutex;
+    std::condition_variable compactWake;
+    std::atomic<bool> compactRequested{false};
+    bool stopCompactor = false;
+    bool compactionFailed = false; // set until a save writes a clean snapshot
+
+    // Active reservations of each room (parallel to rooms), sorted and
+    // non-overlapping, so both ends are sorted and a conflict check is one
+    // binary search. roomsByType lets date queries skip other room types.
+    struct Stay {
+        int checkIn;
+        int checkOut;
+        size_t bookingIndex; // in bookings
+        size_t analyticsRow;
+    };
+    std::vector<std::vector<Stay>> stays;
+    std::array<std::vector<uint32_t>, ROOM_TYPE_COUNT> roomsByType;
+
+    // Columnar copy of the bookings made since enableAnalytics, for reports.
+    // analyticsRows holds the row of each room's open walk-in or group stay;
+    // a reservation keeps its row in its Stay.
+    std::unique_ptr<BookingAnalytics> analytics;
+    std::array<int32_t, ROOM_TYPE_COUNT> nightlyRates{};
+    std::vector<size_t> analyticsRows;
+    mutable std::mutex analyticsMutex;
+
+    // Room number -> position of the first room with that number, and
+    // customer ID -> position in customers. Together with walkIns (room
+    // position -> active booking) they make booking and cancelling O(1)
+    // however many rooms, customers and past bookings there are.
+    IdIndex roomIndex;
+    IdIndex customerIndex;
+
+    static constexpr size_t NO_ROOM = static_cast<size_t>(-1);
+
+    // Position of the first room with this number, or NO_ROOM
+    size_t findRoom(int roomNumber) const {
+        uint32_t pos = roomIndex.find(roomNumber);
+        return pos == IdIndex::EMPTY ? NO_ROOM : pos;
+    }
+
+    // First stay of the room that ends after checkIn, or end()
+    std::vector<Stay>::const_iterator firstStayAfter(size_t pos, int checkIn) const {
+        const auto& list = stays[pos];
+        return std::upper_bound(list.begin(), list.end(), checkIn,
+                                [](int day, const Stay& stay) { return day < stay.checkOut; });
+    }
+
+    bool isFree(size_t pos, int checkIn, int checkOut) const {
+        auto next = firstStayAfter(pos, checkIn);
+        return next == stays[pos].end() || next->checkIn >= checkOut;
+    }
+
+    // Adds a stay unless it overlaps an existing one. Returns it, valid
+    // until the room's stays next change, or nullptr.
+    Stay* addStay(size_t pos, int checkIn, int checkOut) {
+        auto next = firstStayAfter(pos, checkIn);
+        if (next != stays[pos].end() && next->checkIn < checkOut) {
+            return nullptr;
+        }
+        return &*stays[pos].insert(next, Stay{checkIn, checkOut, BookingLog::NONE, BookingAnalytics::NO_ROW});
+    }
+
+    void storeRoom(const Room& room) {
+        roomIndex.insert(room.getRoomNumber(), static_cast<uint32_t>(rooms.size()));
+        rooms.push_back(room);
+        stays.emplace_back();
+        growAtomics<size_t>(walkIns, rooms.size(), BookingLog::NONE);
+        roomsByType[static_cast<size_t>(room.getRoomType())].push_back(static_cast<uint32_t>(rooms.size() - 1));
+        for (auto& bitmap : freeRooms) {
+            bitmap.resize(rooms.size());
+        }
+        if (room.getAvailability()) {
+            freeRooms[static_cast<size_t>(room.getRoomType())].set(rooms.size() - 1);
+        }
+    }
+
+    RoomBitmap& freeRoomsOf(size_t pos) { return freeRooms[static_cast<size_t>(rooms[pos].getRoomType())]; }
+
+    bool roomAvailable(size_t pos) const {
+        return freeRooms[static_cast<size_t>(rooms[pos].getRoomType())].test(pos);
+    }
+
+    // Copy of a room with its live availability
+    Room roomAt(size_t pos) const {
+        Room room = rooms[pos];
+        room.setAvailability(roomAvailable(pos));
+        return room;
+    }
+
+    // Positions of the given room numbers, or an error naming the first
+    // number that is missing or repeated
+    std::vector<size_t> findRooms(const std::vector<int>& roomNumbers, std::string& error) const {
+        IdIndex wanted;
+        wanted.reserve(roomNumbers.size());
+        std::vector<size_t> positions(roomNumbers.size(), NO_ROOM);
+        for (size_t i = 0; i < roomNumbers.size(); ++i) {
+            if (!wanted.insert(roomNumbers[i], static_cast<uint32_t>(i))) {
+                error = "Room " + std::to_string(roomNumbers[i]) + " is listed twice.";
+                return {};
+            }
+            positions[i] = findRoom(roomNumbers[i]);
+            if (positions[i] == NO_ROOM) {
+                error = "Room " + std::to_string(roomNumbers[i]) + " not found.";
+                return {};
+            }
+        }
+        return positions;
+    }
+
+    bool hasCustomer(int customerID) const { return customerIndex.find(customerID) != IdIndex::EMPTY; }
+
+    bool isEmpty() const {
+        return rooms.empty() && customers.empty() && bookings.size() == 0 && archive.size() == 0 && groups.empty();
+    }
+
+    static uint32_t newGeneration() {
+        std::random_device random;
+        uint32_t value = random() ^ static_cast<uint32_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        return value == 0 ? 1 : value;
+    }
+
+    // Once a journal write has failed, changes are refused (NotJournaled)
+    // until a save starts a new journal
+    bool journalFailed() const { return journal && journal->hasFailed(); }
+
+    // Queues a record on the journal and wakes the compactor once the
+    // journal is due to be folded into a snapshot
+    void journalRecord(Journal::Record& record) {
+        if (!journal || replaying) {
+            return;
+        }
+        attachJournal();
+        journal->append(record);
+        if (journal->getRecordCount() >= JOURNAL_COMPACT_RECORDS && !compactRequested.exchange(true)) {
+            std::lock_guard<std::mutex> lock(compactWakeMutex);
+            compactWake.notify_one();
+        }
+    }
+
+    void journalRoom(Journal::RecordType type, size_t pos, int customerID) {
+        Journal::Record record(type);
+        record.putInt(static_cast<int32_t>(pos)).putInt(customerID);
+        journalRecord(record);
+    }
+
+    // Opens an analytics row for a walk-in or group stay starting today
+    void recordCheckIn(size_t pos, int customerID) {
+        if (!analytics || replaying) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(analyticsMutex);
+        if (analyticsRows.size() <= pos) {
+            analyticsRows.resize(rooms.size(), BookingAnalytics::NO_ROW);
+        }
+        const Room& room = rooms[pos];
+        analyticsRows[pos] = analytics->add(room.getRoomNumber(), customerID, room.getRoomType(), today(),
+                                            BookingAnalytics::OPEN_STAY,
+                                            nightlyRates[static_cast<size_t>(room.getRoomType())]);
+    }
+
+    // Closes the room's open row; called before the room is released, so it
+    // cannot race the next guest's recordCheckIn
+    void recordCheckOut(size_t pos) {
+        if (!analytics || replaying) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(analyticsMutex);
+        if (pos < analyticsRows.size() && analyticsRows[pos] != BookingAnalytics::NO_ROW) {
+            analytics->checkOut(analyticsRows[pos], today());
+            analyticsRows[pos] = BookingAnalytics::NO_ROW;
+        }
+    }
+
+    // True once enough of the log is cancelled bookings to be worth a sweep.
+    // Sweeping whenever the cancelled half again outgrows the rest makes the
+    // cost per cancellation O(1) overall. Finished reservations are not
+    // counted, so a large log is also swept once a day to move them out.
+    bool archiveDue() const {
+        size_t cancelled = bookings.cancelledCount();
+        return (cancelled >= ARCHIVE_MIN_BOOKINGS && cancelled * 2 >= bookings.size())
+            || (bookings.size() >= ARCHIVE_MIN_BOOKINGS && today() > lastSweepDay);
+    }
+
+    // Moves cancelled bookings and finished reservations from the log to the
+    // archive, drops the stays of the latter and renumbers the log indices
+    // held by walkIns and stays; catalogMutex is held exclusively, or this
+    // is a compaction's scratch copy
+    void archiveBookings() {
+        int day = today();
+        auto finished = [day](const Booking& booking) { return booking.isReservation() && booking.getCheckOut() <= day; };
+        BookingLog::Remap remap = bookings.sweep(finished, [this](const Booking& booking) { archive.append(booking); });
+        lastSweepDay = day;
+        for (auto& walkIn : walkIns) {
+            size_t index = walkIn.load(std::memory_order_relaxed);
+            if (index != BookingLog::NONE && (index & GROUP_TAG) == 0) {
+                walkIn.store(remap(index), std::memory_order_relaxed);
+            }
+        }
+        for (auto& list : stays) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [&](const Stay& stay) { return !remap.contains(stay.bookingIndex); }),
+                       list.end());
+            for (auto& stay : list) {
+                stay.bookingIndex = remap(stay.bookingIndex);
+            }
+        }
+    }
+
+    // Records a walk-in booking of a room already claimed from freeRooms
+    void storeWalkIn(size_t pos, int customerID) {
+        journalRoom(Journal::BOOK, pos, customerID);
+        recordCheckIn(pos, customerID);
+        walkIns[pos].store(bookings.append(Booking(rooms[pos].getRoomNumber(), customerID)),
+                           std::memory_order_release);
+    }
+
+    // Cancels the room's walk-in booking if the customer holds it, and frees
+    // the room. Only the thread that wins the cancellation releases the room,
+    // and it forgets the booking before the room can be claimed again.
+    bool releaseWalkIn(size_t pos, int customerID) {
+        size_t index = walkIns[pos].load(std::memory_order_acquire);
+        auto ownedByCustomer = [customerID](const Booking& booking) { return booking.getCustomerID() == customerID; };
+        if (index == BookingLog::NONE || (index & GROUP_TAG) != 0 || !bookings.cancelAt(index, ownedByCustomer)) {
+            return false;
+        }
+        journalRoom(Journal::CANCEL, pos, customerID);
+        recordCheckOut(pos);
+        walkIns[pos].store(BookingLog::NONE, std::memory_order_release);
+        freeRoomsOf(pos).set(pos);
+        return true;
+    }
+
+    // Records a group booking of rooms already claimed; returns its index
+    size_t storeGroup(int customerID, const std::vector<size_t>& positions) {
+        std::vector<int> roomNumbers;
+        roomNumbers.reserve(positions.size());
+        Journal::Record record(Journal::BOOK_GROUP);
+        record.putInt(customerID).putInt(static_cast<int32_t>(positions.size()));
+        for (size_t pos : positions) {
+            roomNumbers.push_back(rooms[pos].getRoomNumber());
+            record.putInt(static_cast<int32_t>(pos));
+        }
+        size_t index;
+        {
+            // Journaled under groupMutex so replay assigns the same IDs
+            std::lock_guard<std::mutex> groupLock(groupMutex);
+            index = groups.size();
+            groups.emplace_back(static_cast<int>(index + 1), customerID, std::move(roomNumbers));
+            journalRecord(record);
+        }
+        for (size_t pos : positions) {
+            recordCheckIn(pos, customerID);
+            walkIns[pos].store(GROUP_TAG | index, std::memory_order_release);
+        }
+        return index;
+    }
+
+    // Cancels an active group booking of the customer and frees its rooms
+    bool releaseGroup(int groupID, int customerID) {
+        std::vector<int> roomNumbers;
+        {
+            std::lock_guard<std::mutex> groupLock(groupMutex);
+            if (groupID < 1 || static_cast<size_t>(groupID) > groups.size()
+                || groups[groupID - 1].getCustomerID() != customerID || !groups[groupID - 1].getStatus()) {
+                return false;
+            }
+            groups[groupID - 1].cancelBooking();
+            roomNumbers = groups[groupID - 1].getRoomNumbers();
+            Journal::Record record(Journal::CANCEL_GROUP);
+            record.putInt(groupID).putInt(customerID);
+            journalRecord(record);
+        }
+        std::string error;
+        for (size_t pos : findRooms(roomNumbers, error)) {
+            recordCheckOut(pos);
+            walkIns[pos].store(BookingLog::NONE, std::memory_order_release);
+            freeRoomsOf(pos).set(pos);
+        }
+        return true;
+    }
+
+    // Reservations change only under the exclusive lock
+    bool storeReservation(size_t pos, int customerID, int checkIn, int checkOut) {
+        Stay* stay = addStay(pos, checkIn, checkOut);
+        if (!stay) {
+            return false;
+        }
+        Journal::Record record(Journal::RESERVE);
+        record.putInt(static_cast<int32_t>(pos)).putInt(customerID).putInt(checkIn).putInt(checkOut);
+        journalRecord(record);
+        stay->bookingIndex = bookings.append(Booking(rooms[pos].getRoomNumber(), customerID, checkIn, checkOut));
+        if (analytics && !replaying) {
+            std::lock_guard<std::mutex> lock(analyticsMutex);
+            RoomType roomType = rooms[pos].getRoomType();
+            stay->analyticsRow = analytics->add(rooms[pos].getRoomNumber(), customerID, roomType, checkIn, checkOut,
+                                                nightlyRates[static_cast<size_t>(roomType)]);
+        }
+        return true;
+    }
+
+    // The stay starting on checkIn leads straight to its booking, so this
+    // does not search the log
+    bool releaseReservation(size_t pos, int customerID, int checkIn) {
+        auto stay = firstStayAfter(pos, checkIn);
+        auto ownedByCustomer = [customerID](const Booking& booking) { return booking.getCustomerID() == customerID; };
+        if (stay == stays[pos].end() || stay->checkIn != checkIn
+            || !bookings.cancelAt(stay->bookingIndex, ownedByCustomer)) {
+            return false;
+        }
+        size_t row = stay->analyticsRow;
+        stays[pos].erase(stay);
+        if (analytics && row != BookingAnalytics::NO_ROW) {
+            std::lock_guard<std::mutex> lock(analyticsMutex);
+            analytics->cancel(row);
+        }
+        Journal::Record record(Journal::CANCEL_RESERVATION);
+        record.putInt(static_cast<int32_t>(pos)).putInt(customerID).putInt(checkIn);
+        journalRecord(record);
+        return true;
+    }
+
+    // Re-applies one journaled change; catalogMutex is held exclusively, or
+    // this is a compaction's scratch copy. A ROTATE record moves current on
+    // to the generation of the journal file that follows.
+    void applyRecord(uint8_t type, Journal::Cursor cursor, uint32_t& current) {
+        int32_t first, second, third, fourth;
+        std::string_view name;
+        auto validRoom = [this](int32_t pos) { return pos >= 0 && static_cast<size_t>(pos) < rooms.size(); };
+        switch (type) {
+        case Journal::ADD_ROOM:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getInt(third) && second >= 0
+                && static_cast<size_t>(second) < ROOM_TYPE_COUNT) {
+                Room room(first, static_cast<RoomType>(second));
+                room.setAvailability(third != 0);
+                storeRoom(room);
+            }
+            break;
+        case Journal::ADD_CUSTOMER:
+            if (cursor.getInt(first) && cursor.getString(name)) {
+                storeCustomer(Customer(first, std::string(name)));
+            }
+            break;
+        case Journal::BOOK:
+            if (cursor.getInt(first) && cursor.getInt(second) && validRoom(first) && freeRoomsOf(first).claim(first)) {
+                storeWalkIn(first, second);
+            }
+            break;
+        case Journal::CANCEL:
+            if (cursor.getInt(first) && cursor.getInt(second) && validRoom(first)) {
+                releaseWalkIn(first, second);
+            }
+            break;
+        case Journal::RESERVE:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getInt(third) && cursor.getInt(fourth)
+                && validRoom(first) && third < fourth) {
+                storeReservation(first, second, third, fourth);
+            }
+            break;
+        case Journal::CANCEL_RESERVATION:
+            if (cursor.getInt(first) && cursor.getInt(second) && cursor.getInt(third) && validRoom(first)) {
+                releaseReservation(first, second, third);
+            }
+            break;
+        case Journal::BOOK_GROUP:
+            if (cursor.getInt(first) && cursor.getInt(second)) {
+                std::vector<size_t> positions;
+                std::vector<int> roomNumbers;
+                bool applies = second > 0;
+                int32_t pos;
+                for (int32_t i = 0; i < second && cursor.getInt(pos); ++i) {
+                    if (validRoom(pos)) {
+                        roomNumbers.push_back(rooms[pos].getRoomNumber());
+                        positions.push_back(pos);
+                    }
+                    applies = applies && validRoom(pos) && roomAvailable(pos);
+                }
+                applies = applies && positions.size() == static_cast<size_t>(second);
+                if (applies) {
+                    for (size_t claimed : positions) {
+                        freeRoomsOf(claimed).claim(claimed);
+                    }
+                    storeGroup(first, positions);
+                } else {
+                    // Group IDs are positions in groups, so a group that no
+                    // longer applies still takes its ID, cancelled, or later
+                    // CANCEL_GROUP records would hit the wrong group
+                    std::lock_guard<std::mutex> groupLock(groupMutex);
+                    groups.emplace_back(static_cast<int>(groups.size() + 1), first, std::move(roomNumbers));
+                    groups.back().cancelBooking();
+                }
+            }
+            break;
+        case Journal::CANCEL_GROUP:
+            if (cursor.getInt(first) && cursor.getInt(second)) {
+                releaseGroup(first, second);
+            }
+            break;
+        case Journal::ROTATE:
+            if (cursor.getInt(first)) {
+                current = static_cast<uint32_t>(first);
+            }
+            break;
+        }
+    }
+
+    // Replays a journal file if it extends current; returns the number of
+    // changes applied
+    size_t replayJournal(const std::string& file, uint32_t& current) {
+        size_t applied = 0;
+        replaying = true;
+        Journal::replay(file, current, [&](uint8_t type, Journal::Cursor cursor) {
+            applied += type != Journal::ROTATE;
+            applyRecord(type, cursor, current);
+        });
+        replaying = false;
+        if (archiveDue()) {
+            archiveBookings();
+        }
+        return applied;
+    }
+
+    // Called before the first change of a hotel that has neither loaded nor
+    // saved. Appending to the old journal would make the next load (or a
+    // compaction) fold this session's changes into a snapshot they never
+    // saw, so the old journal and any sealed one are moved to *.old and an
+    // empty journal extending an empty hotel (generation 0) is started.
+    void attachJournal() {
+        if (journalAttached.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(attachMutex);
+        if (journalAttached.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::string sealed = journal->getSealedPath();
+        bool hasSealed = std::ifstream(sealed).good();
+        if (journal->getRecordCount() > 0 || hasSealed) {
+            std::cerr << "Warning: " << HOTEL_JOURNAL_FILE << " was not loaded; moved it to "
+                      << HOTEL_JOURNAL_FILE << ".old before recording new changes.\n";
+        }
+        if (hasSealed) {
+            renameOver(sealed, sealed + ".old");
+        }
+        if (journal->getRecordCount() > 0 || journal->getGeneration() != 0) {
+            journal->reset(0, true);
+        }
+        journalAttached.store(true, std::memory_order_release);
+    }
+
+    // Writes a snapshot under a new generation and starts an empty journal
+    // on top of it; catalogMutex and compactMutex are held
+    bool saveLocked() {
+        uint32_t next = newGeneration();
+        if (!saveText(next)) {
+            return false;
+        }
+        if (journal) {
+            journal->reset(next);
+            std::remove(journal->getSealedPath().c_str());
+            compactionFailed = false;
+            journalAttached.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Seals the journal and folds it into a new snapshot by loading the last
+    // snapshot and the sealed journal into a scratch Hotel. The live hotel is
+    // never locked: bookings carry on into the new journal meanwhile.
+    void compact() {
+        std::lock_guard<std::mutex> lock(compactMutex);
+        if (compactionFailed || journal->getRecordCount() < JOURNAL_COMPACT_RECORDS) {
+            return; // a save got there first, or an earlier attempt left the sealed journal to keep
+        }
+        // A journal started by a hotel that never loaded (generation 0) does
+        // not extend the snapshot on disk, so it waits for the next save
+        if (journal->getGeneration() == 0 && std::ifstream(HOTEL_DATA_FILE).good()) {
+            compactionFailed = true;
+            return;
+        }
+        uint32_t next = newGeneration();
+        uint32_t base;
+        if (!journal->rotate(next, base)) {
+            compactionFailed = true; // nothing more is journaled until a save
+            return;
+        }
+        std::string sealed = journal->getSealedPath();
+
+        // No snapshot yet means the empty hotel the first journal extends
+        Hotel scratch(false);
+        uint32_t current = 0;
+        size_t skipped = 0;
+        scratch.loadText(current, skipped);
+        if (current == base) {
+            scratch.replayJournal(sealed, current);
+        }
+        if (current != next || !scratch.saveText(next)) {
+            std::cerr << "Warning: could not fold " << sealed << " into " << HOTEL_DATA_FILE
+                      << "; it is kept until the next save.\n";
+            compactionFailed = true;
+            return;
+        }
+        std::remove(sealed.c_str());
+    }
+
+    void compactLoop() {
+        std::unique_lock<std::mutex> lock(compactWakeMutex);
+        while (true) {
+            compactWake.wait(lock, [this] { return stopCompactor || compactRequested; });
+            if (stopCompactor) {
+                return;
+            }
+            lock.unlock();
+            compact();
+            compactRequested = false;
+            lock.lock();
+        }
+    }
+
+    bool saveText(uint32_t generation) const {
+        std::string temporary = HOTEL_DATA_FILE + ".tmp";
+        std::ofstream file(temporary);
+        if (!file) {
+            std::cerr << "Error opening file for saving data.\n";
+            return false;
+        }
+
+        file << "Generation:" << generation << "\n";
+
+        // Save rooms
+        file << "Rooms:\n";
+        for (size_t pos = 0; pos < rooms.size(); ++pos) {
+            const Room& room = rooms[pos];
+            file << room.getRoomNumber() << "|" << roomTypeName(room.getRoomType()) << "|" 
+                 << (roomAvailable(pos) ? "1" : "0") << "\n";
+        }
+
+        // Save customers
+        file << "Customers:\n";
+        for (const auto& customer : customers) {
+            file << customer.getID() << "|" << customer.getName() << "\n";
+        }
+
+        // Save bookings
+        file << "Bookings:\n";
+        auto writeBooking = [&file](const Booking& booking) {
+            file << booking.getRoomNumber() << "|" << booking.getCustomerID()
+                 << "|" << (booking.getStatus() ? "1" : booking.hasFinished() ? "2" : "0");
+            if (booking.isReservation()) {
+                file << "|" << formatDate(booking.getCheckIn()) << "|" << formatDate(booking.getCheckOut());
+            }
+            file << "\n";
+        };
+        archive.forEach(writeBooking);
+        bookings.forEach(writeBooking);
+
+        // Save group bookings: id|customer|active|room,room,...
+        file << "Groups:\n";
+        for (const auto& group : groups) {
+            file << group.getID() << "|" << group.getCustomerID() << "|" << (group.getStatus() ? "1" : "0") << "|";
+            for (size_t i = 0; i < group.getRoomNumbers().size(); ++i) {
+                file << (i > 0 ? "," : "") << group.getRoomNumbers()[i];
+            }
+            file << "\n";
+        }
+
+        file.close();
+        if (!file || !replaceFile(temporary, HOTEL_DATA_FILE)) {
+            std::cerr << "Error writing data file.\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Reads HOTEL_DATA_FILE into the hotel, counting skipped lines. Returns
+    // false if it cannot be opened; files without a Generation line are 0.
+    bool loadText(uint32_t& loadedGeneration, size_t& skipped) {
+        DelimitedReader reader(HOTEL_DATA_FILE);
+        if (!reader.isOpen()) {
+            return false;
+        }
+
+        enum Section { NONE, ROOMS, CUSTOMERS, BOOKINGS, GROUPS };
+        Section currentSection = NONE;
+        auto malformed = [&](const char* record) {
+            std::cerr << "Warning: " << HOTEL_DATA_FILE << ":" << reader.getLineNumber()
+                      << ": malformed " << record << " line skipped.\n";
+            ++skipped;
+        };
+
+        while (reader.next()) {
+            std::string_view line = reader.getLine();
+            if (line == "Rooms:") {
+                currentSection = ROOMS;
+                continue;
+            } else if (line == "Customers:") {
+                currentSection = CUSTOMERS;
+                continue;
+            } else if (line == "Bookings:") {
+                currentSection = BOOKINGS;
+                continue;
+            } else if (line == "Groups:") {
+                currentSection = GROUPS;
+                continue;
+            } else if (line.empty()) {
+                continue;
+            }
+
+            const auto& fields = reader.getFields();
+            if (currentSection == NONE && line.compare(0, 11, "Generation:") == 0) {
+                if (!parseInt(line.substr(11), loadedGeneration)) {
+                    malformed("generation");
+                    continue;
+                }
+
+            } else if (currentSection == ROOMS) {
+                // Parse room data: number|type|available
+                int roomNumber;
+                RoomType roomType;
+                bool isAvailable;
+                if (fields.size() != 3 || !parseInt(fields[0], roomNumber) || !parseRoomType(fields[1], roomType)
+                    || !parseFlag(fields[2], isAvailable)) {
+                    malformed("room");
+                    continue;
+                }
+                if (findRoom(roomNumber) != NO_ROOM) {
+                    std::cerr << "Warning: " << HOTEL_DATA_FILE << ":" << reader.getLineNumber()
+                              << ": duplicate room number " << roomNumber << " skipped.\n";
+                    ++skipped;
+                    continue;
+                }
+
+                Room room(roomNumber, roomType);
+                room.setAvailability(isAvailable);
+                storeRoom(room);
+
+            } else if (currentSection == CUSTOMERS) {
+                // Parse customer data: id|name (the name runs to the end of the line)
+                int customerID;
+                if (fields.size() < 2 || !parseInt(fields[0], customerID)) {
+                    malformed("customer");
+                    continue;
+                }
+
+                if (!storeCustomer(Customer(customerID, std::string(line.substr(fields[0].size() + 1))))) {
+                    std::cerr << "Warning: " << HOTEL_DATA_FILE << ":" << reader.getLineNumber()
+                              << ": duplicate customer ID " << customerID << " skipped.\n";
+                    ++skipped;
+                }
+
+            } else if (currentSection == BOOKINGS) {
+                // Parse booking data: room|customer|status[|checkIn|checkOut],
+                // status 1 active, 0 cancelled, 2 finished (reservations only)
+                int roomNumber, customerID, status;
+                int checkIn = 0, checkOut = 0;
+                if ((fields.size() != 3 && fields.size() != 5) || !parseInt(fields[0], roomNumber)
+                    || !parseInt(fields[1], customerID) || !parseInt(fields[2], status) || status < 0
+                    || status > (fields.size() == 5 ? 2 : 1)
+                    || (fields.size() == 5 && (!parseDate(fields[3], checkIn) || !parseDate(fields[4], checkOut)
+                                               || checkOut <= checkIn))) {
+                    malformed("booking");
+                    continue;
+                }
+
+                bool isActive = status == 1;
+                Stay* stay = nullptr;
+                if (isActive && fields.size() == 5) {
+                    size_t pos = findRoom(roomNumber);
+                    if (pos == NO_ROOM || !(stay = addStay(pos, checkIn, checkOut))) {
+                        std::cerr << "Warning: " << HOTEL_DATA_FILE << ":" << reader.getLineNumber()
+                                  << ": reservation for an unknown room or overlapping another skipped.\n";
+                        ++skipped;
+                        continue;
+                    }
+                }
+                Booking booking(roomNumber, customerID, checkIn, checkOut);
+                if (!isActive) {
+                    if (status == 2) {
+                        booking.finishBooking();
+                    } else {
+                        booking.cancelBooking();
+                    }
+                    archive.append(booking);
+                    continue;
+                }
+                size_t index = bookings.append(booking);
+                if (stay) {
+                    stay->bookingIndex = index;
+                } else if (!booking.isReservation()) {
+                    size_t pos = findRoom(roomNumber);
+                    if (pos != NO_ROOM) {
+                        walkIns[pos].store(index, std::memory_order_relaxed);
+                    }
+                }
+
+            } else if (currentSection == GROUPS) {
+                // Parse group data: id|customer|active|room,room,... (IDs are
+                // renumbered in file order)
+                int groupID, customerID;
+                bool isActive;
+                std::vector<int> roomNumbers;
+                bool valid = fields.size() == 4 && parseInt(fields[0], groupID) && parseInt(fields[1], customerID)
+                             && parseFlag(fields[2], isActive);
+                for (size_t start = 0; valid && start <= fields[3].size();) {
+                    size_t comma = std::min(fields[3].find(',', start), fields[3].size());
+                    int roomNumber;
+                    valid = parseInt(fields[3].substr(start, comma - start), roomNumber);
+                    roomNumbers.push_back(roomNumber);
+                    start = comma + 1;
+                }
+                if (!valid) {
+                    malformed("group");
+                    continue;
+                }
+
+                size_t index = groups.size();
+                groups.emplace_back(static_cast<int>(index + 1), customerID, roomNumbers);
+                if (isActive) {
+                    std::string error;
+                    for (size_t pos : findRooms(roomNumbers, error)) {
+                        walkIns[pos].store(GROUP_TAG | index, std::memory_order_relaxed);
+                    }
+                } else {
+                    groups.back().cancelBooking();
+                }
+
+            } else {
+                malformed("unsectioned");
+            }
+        }
+
+        return true;
+    }
+
+    // Adds a customer unless the ID is taken
+    bool storeCustomer(const Customer& customer) {
+        if (!customerIndex.insert(customer.getID(), static_cast<uint32_t>(customers.size()))) {
+            return false;
+        }
+        customers.push_back(customer);
+        return true;
+    }
+
+public:
+    // With durable set, changes are journaled to HOTEL_JOURNAL_FILE and
+    // compacted into HOTEL_DATA_FILE in the background
+    explicit Hotel(bool durable = true) {
+        if (durable) {
+            journal.reset(new Journal(HOTEL_JOURNAL_FILE));
+            compactor = std::thread([this] { compactLoop(); });
+        }
+    }
+
+    ~Hotel() {
+        if (compactor.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(compactWakeMutex);
+                stopCompactor = true;
+            }
+            compactWake.notify_one();
+            compactor.join();
+        }
+    }
+
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+    // True if there is a snapshot or journal for loadData to read
+    bool hasSavedState() const {
+        return std::ifstream(HOTEL_DATA_FILE).good()
+            || (journal && (journal->getRecordCount() > 0 || std::ifstream(journal->getSealedPath()).good()));
+    }
+
+    // Adds a room unless its number is taken (loadText skips such rooms too)
+    BookingStatus tryAddRoom(const Room& room) {
+        if (journalFailed()) {
+            return BookingStatus::NotJournaled;
+        }
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        if (findRoom(room.getRoomNumber()) != NO_ROOM) {
+            return BookingStatus::RoomExists;
+        }
+        storeRoom(room);
+        Journal::Record record(Journal::ADD_ROOM);
+        record.putInt(room.getRoomNumber()).putInt(static_cast<int32_t>(room.getRoomType()))
+            .putInt(room.getAvailability() ? 1 : 0);
+        journalRecord(record);
+        return BookingStatus::Ok;
+    }
+
+    void addRoom(const Room& room) {
+        BookingStatus status = tryAddRoom(room);
+        if (status == BookingStatus::RoomExists) {
+            std::cerr << "Error: Room " << room.getRoomNumber() << " already exists.\n";
+        } else if (status != BookingStatus::Ok) {
+            std::cerr << "Error: " << describe(status) << "\n";
+        }
+    }
+
+    BookingStatus tryAddCustomer(const Customer& customer) {
+        if (journalFailed()) {
+            return BookingStatus::NotJournaled;
+        }
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        if (!storeCustomer(customer)) {
+            return BookingStatus::CustomerExists;
+        }
+        Journal::Record record(Journal::ADD_CUSTOMER);
+        record.putInt(customer.getID()).putString(customer.getName());
+        journalRecord(record);
+        return BookingStatus::Ok;
+    }
+
+    // Returns false, adding nothing, if a customer with this ID exists
+    bool addCustomer(const Customer& customer) {
+        BookingStatus status = tryAddCustomer(customer);
+        if (status == BookingStatus::CustomerExists) {
+            std::cerr << "Error: Customer ID " << customer.getID() << " already exists.\n";
+        } else if (status != BookingStatus::Ok) {
+            std::cerr << "Error: " << describe(status) << "\n";
+        }
+        return status == BookingStatus::Ok;
+    }
+
+    bool customerExists(int customerID) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        return hasCustomer(customerID);
+    }
+
+    void showCustomers() const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::cout << "\nList of Customers:\n";
+        for (const auto& customer : customers) {
+            std::cout << "Customer ID: " << customer.getID() << " | Name: " << customer.getName() << std::endl;
+        }
+    }
+
+    // Every booking the customer has made, cancelled and finished ones (from
+    // the archive) first, then the rest, each oldest first
+    std::vector<Booking> getBookingHistory(int customerID) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::vector<Booking> history;
+        auto collect = [&](const Booking& booking) {
+            if (booking.getCustomerID() == customerID) {
+                history.push_back(booking);
+            }
+        };
+        archive.forEach(collect);
+        bookings.forEach(collect);
+        return history;
+    }
+
+    void showBookingHistory(int customerID) const {
+        std::vector<Booking> history = getBookingHistory(customerID);
+        std::cout << "\nBookings of Customer ID " << customerID << ":\n";
+        for (const auto& booking : history) {
+            std::cout << "Room Number: " << booking.getRoomNumber() << " | ";
+            if (booking.isReservation()) {
+                std::cout << formatDate(booking.getCheckIn()) << " to " << formatDate(booking.getCheckOut());
+            } else {
+                std::cout << "Walk-in";
+            }
+            // A reservation not swept into the archive yet may be over too
+            bool finished = booking.hasFinished()
+                            || (booking.getStatus() && booking.isReservation() && booking.getCheckOut() <= today());
+            std::cout << " | " << (finished ? "Finished" : booking.getStatus() ? "Active" : "Canceled") << std::endl;
+        }
+        std::cout << history.size() << " booking(s).\n";
+    }
+
+    // Books a room without throwing or printing
+    BookingStatus tryBookRoom(int roomNumber, int customerID) {
+        if (journalFailed()) {
+            return BookingStatus::NotJournaled;
+        }
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        if (!hasCustomer(customerID)) {
+            return BookingStatus::CustomerNotFound;
+        }
+        size_t pos = findRoom(roomNumber);
+        if (pos == NO_ROOM) {
+            return BookingStatus::RoomNotFound;
+        }
+        if (!freeRoomsOf(pos).claim(pos)) {
+            return BookingStatus::RoomUnavailable;
+        }
+        storeWalkIn(pos, customerID);
+        return BookingStatus::Ok;
+    }
+
+    void bookRoom(int roomNumber, int customerID) {
+        BookingStatus status = tryBookRoom(roomNumber, customerID);
+        if (status == BookingStatus::CustomerNotFound) {
+            std::cerr << "Error: Customer ID " << customerID << " does not exist.\n";
+            return;
+        }
+        if (status != BookingStatus::Ok) {
+            throw std::runtime_error(describe(status));
+        }
+        if (verbose) {
+            std::cout << "Room " << roomNumber << " booked successfully for Customer ID " << customerID << ".\n";
+        }
+    }
+
+    // Books the first free room of the given type, returning its number
+    // through roomNumber, without throwing or printing
+    BookingStatus tryBookAnyRoom(RoomType roomType, int customerID, int& roomNumber) {
+        if (journalFailed()) {
+            return BookingStatus::NotJournaled;
+        }
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        if (!hasCustomer(customerID)) {
+            return BookingStatus::CustomerNotFound;
+        }
+        RoomBitmap& bitmap = freeRooms[static_cast<size_t>(roomType)];
+        size_t pos;
+        do {
+            pos = bitmap.findFirst();
+            if (pos == RoomBitmap::NONE) {
+                return BookingStatus::NoFreeRoom;
+            }
+        } while (!bitmap.claim(pos));
+        roomNumber = rooms[pos].getRoomNumber();
+        storeWalkIn(pos, customerID);
+        return BookingStatus::Ok;
+    }
+
+    // Books the first free room of the given type and returns its number
+    // (-1 if the customer does not exist)
+    int bookAnyRoom(RoomType roomType, int customerID) {
+        int roomNumber = -1;
+        BookingStatus status = tryBookAnyRoom(roomType, customerID, roomNumber);
+        if (status == BookingStatus::CustomerNotFound) {
+            std::cerr << "Error: Customer ID " << customerID << " does not exist.\n";
+            return -1;
+        }
+        if (status != BookingStatus::Ok) {
+            throw std::runtime_error(describe(status));
+        }
+        if (verbose) {
+            std::cout << "Room " << roomNumber << " booked successfully for Customer ID " << customerID << ".\n";
+        }
+        return roomNumber;
+    }
+
+    // Books every listed room for the customer, or none of them, and records
+    // one group booking. Returns its ID (-1 if the customer does not exist).
+    int bookRooms(int customerID, const std::vector<int>& roomNumbers) {
+        if (journalFailed()) {
+            throw std::runtime_error(describe(BookingStatus::NotJournaled));
+        }
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        if (!hasCustomer(customerID)) {
+            std::cerr << "Error: Customer ID " << customerID << " does not exist.\n";
+            return -1;
+        }
+        if (roomNumbers.empty()) {
+            throw std::runtime_error("No rooms requested.");
+        }
+
+        std::string error;
+        std::vector<size_t> positions = findRooms(roomNumbers, error);
+        if (positions.empty()) {
+            throw std::runtime_error(error);
+        }
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (!freeRoomsOf(positions[i]).claim(positions[i])) {
+                // Roll back the rooms claimed so far
+                int taken = roomNumbers[i];
+                while (i-- > 0) {
+                    freeRoomsOf(positions[i]).set(positions[i]);
+                }
+                throw std::runtime_error("Room " + std::to_string(taken) + " is not available.");
+            }
+        }
+
+        size_t index = storeGroup(customerID, positions);
+        if (verbose) {
+            std::cout << roomNumbers.size() << " rooms booked as group " << index + 1 << " for Customer ID "
+                      << customerID << ".\n";
+        }
+        return static_cast<int>(index + 1);
+    }
+
+    void cancelGroupBooking(int groupID, int customerID) {
+        if (journalFailed()) {
+            throw std::runtime_error(describe(BookingStatus::NotJournaled));
+        }
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        if (!releaseGroup(groupID, customerID)) {
+            throw std::runtime_error("Group booking not found or already canceled.");
+        }
+        if (verbose) {
+            std::cout << "Group booking canceled successfully.\n";
+        }
+    }
+
+    // Reserves the room for the nights [checkIn, checkOut)
+    void reserveRoom(int roomNumber, int customerID, int checkIn, int checkOut) {
+        if (journalFailed()) {
+            throw std::runtime_error(describe(BookingStatus::NotJournaled));
+        }
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        if (!hasCustomer(customerID)) {
+            std::cerr << "Error: Customer ID " << customerID << " does not exist.\n";
+            return;
+        }
+        if (checkOut <= checkIn) {
+            throw std::runtime_error("Check-out must be after check-in.");
+        }
+
+        size_t pos = findRoom(roomNumber);
+        if (pos == NO_ROOM) {
+            throw std::runtime_error("Room not found.");
+        }
+        if (!storeReservation(pos, customerID, checkIn, checkOut)) {
+            throw std::runtime_error("Room is already reserved for some of those dates.");
+        }
+        if (archiveDue()) {
+            archiveBookings();
+        }
+        if (verbose) {
+            std::cout << "Room " << roomNumber << " reserved for Customer ID " << customerID << " from "
+                      << formatDate(checkIn) << " to " << formatDate(checkOut) << ".\n";
+        }
+    }
+
+    void cancelReservation(int roomNumber, int customerID, int checkIn) {
+        if (journalFailed()) {
+            throw std::runtime_error(describe(BookingStatus::NotJournaled));
+        }
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        size_t pos = findRoom(roomNumber);
+        if (pos == NO_ROOM || !releaseReservation(pos, customerID, checkIn)) {
+            throw std::runtime_error("Reservation not found or already canceled.");
+        }
+        if (archiveDue()) {
+            archiveBookings();
+        }
+        if (verbose) {
+            std::cout << "Reservation canceled successfully.\n";
+        }
+    }
+
+    bool isRoomFree(int roomNumber, int checkIn, int checkOut) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        size_t pos = findRoom(roomNumber);
+        return pos != NO_ROOM && isFree(pos, checkIn, checkOut);
+    }
+
+    // Numbers of the rooms of a type with no reservation overlapping [checkIn, checkOut)
+    std::vector<int> findFreeRooms(RoomType roomType, int checkIn, int checkOut) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::vector<int> result;
+        for (uint32_t pos : roomsByType[static_cast<size_t>(roomType)]) {
+            if (isFree(pos, checkIn, checkOut)) {
+                result.push_back(rooms[pos].getRoomNumber());
+            }
+        }
+        return result;
+    }
+
+    // Cancels a walk-in booking without throwing or printing
+    BookingStatus tryCancelBooking(int roomNumber, int customerID) {
+        if (journalFailed()) {
+            return BookingStatus::NotJournaled;
+        }
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        size_t pos = findRoom(roomNumber);
+        if (pos == NO_ROOM) {
+            return BookingStatus::RoomNotFound;
+        }
+        size_t index = walkIns[pos].load(std::memory_order_acquire);
+        if (index != BookingLog::NONE && (index & GROUP_TAG) != 0) {
+            return BookingStatus::GroupBooked;
+        }
+        if (!releaseWalkIn(pos, customerID)) {
+            return BookingStatus::NoActiveBooking;
+        }
+        if (archiveDue()) {
+            lock.unlock();
+            std::unique_lock<std::shared_mutex> exclusive(catalogMutex);
+            if (archiveDue()) {
+                archiveBookings();
+            }
+        }
+        return BookingStatus::Ok;
+    }
+
+    // Cancels a walk-in booking; reservations go through cancelReservation
+    void cancelBooking(int roomNumber, int customerID) {
+        BookingStatus status = tryCancelBooking(roomNumber, customerID);
+        if (status != BookingStatus::Ok) {
+            throw std::runtime_error(describe(status));
+        }
+        if (verbose) {
+            std::cout << "Booking canceled successfully.\n";
+        }
+    }
+
+    // Kept up to date by every claim and release, so this is O(1)
+    std::array<RoomTypeOccupancy, ROOM_TYPE_COUNT> getOccupancy() const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::array<RoomTypeOccupancy, ROOM_TYPE_COUNT> occupancy;
+        for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+            occupancy[type].available = freeRooms[type].count();
+            occupancy[type].occupied = roomsByType[type].size() - std::min(occupancy[type].available,
+                                                                           roomsByType[type].size());
+        }
+        return occupancy;
+    }
+
+    // Cross-checks the booking state: the free-room bitmaps, walkIns, the
+    // active walk-ins in the log, the group bookings and the reservation
+    // stays must all agree. Prints each mismatch to stderr and returns how
+    // many there were.
+    size_t checkConsistency() const {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        size_t problems = 0;
+        auto report = [&problems](const std::string& message) {
+            std::cerr << "Inconsistent: " << message << "\n";
+            ++problems;
+        };
+
+        std::vector<Booking> log;
+        bookings.forEach([&log](const Booking& booking) { log.push_back(booking); });
+        if (log.size() != bookings.size()) {
+            report("the booking log has unpublished entries");
+        }
+        for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+            if (!freeRooms[type].consistent()) {
+                report(std::string("the free-room count or summary of ") + roomTypeName(static_cast<RoomType>(type))
+                       + " rooms is wrong");
+            }
+        }
+
+        size_t heldWalkIns = 0;
+        for (size_t pos = 0; pos < rooms.size(); ++pos) {
+            std::string which = "room " + std::to_string(rooms[pos].getRoomNumber());
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                if (type != static_cast<size_t>(rooms[pos].getRoomType()) && freeRooms[type].test(pos)) {
+                    report(which + " is free in another type's bitmap");
+                }
+            }
+            size_t index = walkIns[pos].load(std::memory_order_acquire);
+            if (index == BookingLog::NONE) {
+                if (rooms[pos].getAvailability() && !roomAvailable(pos)) {
+                    report(which + " is neither free nor booked");
+                }
+                continue;
+            }
+            if (roomAvailable(pos)) {
+                report(which + " is booked and free at once");
+            }
+            if ((index & GROUP_TAG) != 0) {
+                size_t group = index & ~GROUP_TAG;
+                const std::vector<int>* numbers = group < groups.size() ? &groups[group].getRoomNumbers() : nullptr;
+                if (!numbers || !groups[group].getStatus()
+                    || std::find(numbers->begin(), numbers->end(), rooms[pos].getRoomNumber()) == numbers->end()) {
+                    report(which + " is held by a group booking that is cancelled or does not list it");
+                }
+                continue;
+            }
+            ++heldWalkIns;
+            if (index >= log.size() || !log[index].getStatus() || log[index].isReservation()
+                || log[index].getRoomNumber() != rooms[pos].getRoomNumber()) {
+                report(which + " points at a booking that is not its active walk-in");
+            }
+        }
+        size_t activeWalkIns = std::count_if(log.begin(), log.end(), [](const Booking& booking) {
+            return booking.getStatus() && !booking.isReservation();
+        });
+        if (activeWalkIns != heldWalkIns) {
+            report(std::to_string(activeWalkIns) + " walk-ins are active but rooms hold "
+                   + std::to_string(heldWalkIns));
+        }
+
+        for (size_t group = 0; group < groups.size(); ++group) {
+            if (!groups[group].getStatus()) {
+                continue;
+            }
+            std::string error;
+            for (size_t pos : findRooms(groups[group].getRoomNumbers(), error)) {
+                if (walkIns[pos].load(std::memory_order_acquire) != (GROUP_TAG | group)) {
+                    report("group " + std::to_string(group + 1) + " does not hold room "
+                           + std::to_string(rooms[pos].getRoomNumber()));
+                }
+            }
+        }
+
+        size_t activeReservations = 0;
+        for (size_t pos = 0; pos < rooms.size(); ++pos) {
+            const Stay* previous = nullptr;
+            for (const Stay& stay : stays[pos]) {
+                const Booking* booking = stay.bookingIndex < log.size() ? &log[stay.bookingIndex] : nullptr;
+                if ((previous && stay.checkIn < previous->checkOut) || !booking || !booking->getStatus()
+                    || booking->getCheckIn() != stay.checkIn || booking->getCheckOut() != stay.checkOut
+                    || booking->getRoomNumber() != rooms[pos].getRoomNumber()) {
+                    report("a stay of room " + std::to_string(rooms[pos].getRoomNumber())
+                           + " overlaps another or does not match its booking");
+                }
+                previous = &stay;
+                ++activeReservations;
+            }
+        }
+        size_t loggedReservations = std::count_if(log.begin(), log.end(), [](const Booking& booking) {
+            return booking.getStatus() && booking.isReservation();
+        });
+        if (activeReservations != loggedReservations) {
+            report(std::to_string(loggedReservations) + " reservations are active but rooms hold "
+                   + std::to_string(activeReservations));
+        }
+        return problems;
+    }
+
+    // Rooms matching the filter in the order they were added. Returns at
+    // most pageSize rooms starting at match number page * pageSize; the
+    // cost depends on the page, not on the number of rooms before it.
+    RoomPage listRooms(const RoomFilter& filter, size_t page, size_t pageSize) const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        RoomPage result;
+        size_t skip = page * pageSize;
+        if (!filter.availableOnly) {
+            const size_t type = static_cast<size_t>(filter.roomType);
+            result.totalMatches = filter.allTypes ? rooms.size() : roomsByType[type].size();
+            for (size_t i = skip; i < result.totalMatches && result.rooms.size() < pageSize; ++i) {
+                result.rooms.push_back(roomAt(filter.allTypes ? i : roomsByType[type][i]));
+            }
+            return result;
+        }
+
+        // Free rooms: walk the bitmaps a word at a time, skipping whole
+        // words by popcount until the page starts
+        size_t firstType = filter.allTypes ? 0 : static_cast<size_t>(filter.roomType);
+        size_t lastType = filter.allTypes ? ROOM_TYPE_COUNT : firstType + 1;
+        for (size_t type = firstType; type < lastType; ++type) {
+            result.totalMatches += freeRooms[type].count();
+        }
+        for (size_t w = 0; w < freeRooms[firstType].wordCount() && result.rooms.size() < pageSize; ++w) {
+            uint64_t word = 0;
+            for (size_t type = firstType; type < lastType; ++type) {
+                word |= freeRooms[type].word(w);
+            }
+            unsigned bits = countBits(word);
+            if (skip >= bits) {
+                skip -= bits;
+                continue;
+            }
+            for (; word != 0 && result.rooms.size() < pageSize; word &= word - 1) {
+                if (skip > 0) {
+                    --skip;
+                    continue;
+                }
+                result.rooms.push_back(roomAt(w * 64 + countTrailingZeros(word)));
+            }
+        }
+        return result;
+    }
+
+    // Prints the per-type occupancy and one page of the matching rooms
+    void checkAvailability(const RoomFilter& filter = RoomFilter(), size_t page = 0,
+                           size_t pageSize = ROOM_PAGE_SIZE) const {
+        std::array<RoomTypeOccupancy, ROOM_TYPE_COUNT> occupancy = getOccupancy();
+        std::cout << "\nOccupancy:\n";
+        for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+            std::cout << roomTypeName(static_cast<RoomType>(type)) << ": " << occupancy[type].available
+                      << " available, " << occupancy[type].occupied << " occupied\n";
+        }
+
+        RoomPage rooms = listRooms(filter, page, pageSize);
+        std::cout << "\nRoom Availability:\n";
+        for (const auto& room : rooms.rooms) {
+            room.displayDetails();
+        }
+        std::cout << "Showing " << rooms.rooms.size() << " of " << rooms.totalMatches << " rooms.\n";
+    }
+
+    // Starts recording bookings made from now on for getReport, each stay
+    // priced at the nightly rate (in cents) of its room type
+    void enableAnalytics(const std::array<int32_t, ROOM_TYPE_COUNT>& rates = NIGHTLY_RATES) {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        std::lock_guard<std::mutex> analyticsLock(analyticsMutex);
+        if (!analytics) {
+            analytics.reset(new BookingAnalytics());
+        }
+        nightlyRates = rates;
+    }
+
+    // Occupancy and revenue for each night in [firstDay, lastDay), and the
+    // cancellations among stays checking in then. Guests still in their
+    // rooms count up to tonight. The locks are only held to take the row
+    // count and room counts; the scan, split across threads, runs while
+    // bookings carry on, and may or may not see a cancellation made during
+    // it. Throws if analytics is off.
+    BookingReport getReport(int firstDay, int lastDay,
+                            size_t threads = std::max(1u, std::thread::hardware_concurrency())) const {
+        BookingReport report;
+        const BookingAnalytics* columns;
+        size_t rows;
+        {
+            std::shared_lock<std::shared_mutex> lock(catalogMutex);
+            std::lock_guard<std::mutex> analyticsLock(analyticsMutex);
+            if (!analytics) {
+                throw std::logic_error("Error: Analytics is not enabled.");
+            }
+            columns = analytics.get();
+            rows = analytics->size();
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                report.rooms[type] = roomsByType[type].size();
+            }
+        }
+        size_t days = lastDay > firstDay ? static_cast<size_t>(lastDay - firstDay) : 0;
+        report.occupancy = columns->dailyOccupancy(rows, firstDay, days, today() + 1, threads);
+        report.cancellations = columns->cancellations(rows, firstDay, lastDay, threads);
+        return report;
+    }
+
+    // Prints occupancy per room type and revenue per available room (RevPAR)
+    // for each night, then totals and cancellation ratios per type
+    void printReport(int firstDay, int lastDay) const {
+        BookingReport report = getReport(firstDay, lastDay);
+        size_t totalRooms = 0;
+        for (size_t rooms : report.rooms) {
+            totalRooms += rooms;
+        }
+        auto percent = [](int64_t part, uint64_t whole) { return whole == 0 ? 0.0 : 100.0 * part / whole; };
+        auto money = [](double cents, uint64_t per) { return per == 0 ? 0.0 : cents / 100.0 / per; };
+        char line[160];
+
+        std::cout << "\nDate        Single  Double   Suite    RevPAR\n";
+        for (size_t day = 0; day < report.occupancy.days; ++day) {
+            int64_t revenue = 0;
+            for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+                revenue += report.occupancy.revenue[type][day];
+            }
+            std::snprintf(line, sizeof(line), "%s %6.1f%% %6.1f%% %6.1f%% %9.2f\n",
+                          formatDate(firstDay + static_cast<int>(day)).c_str(),
+                          percent(report.occupancy.occupied[0][day], report.rooms[0]),
+                          percent(report.occupancy.occupied[1][day], report.rooms[1]),
+                          percent(report.occupancy.occupied[2][day], report.rooms[2]),
+                          money(static_cast<double>(revenue), totalRooms));
+            std::cout << line;
+        }
+
+        std::cout << "\nType     Occupancy    Revenue    RevPAR  Cancelled\n";
+        for (size_t type = 0; type < ROOM_TYPE_COUNT; ++type) {
+            int64_t nights = 0, revenue = 0;
+            for (size_t day = 0; day < report.occupancy.days; ++day) {
+                nights += report.occupancy.occupied[type][day];
+                revenue += report.occupancy.revenue[type][day];
+            }
+            uint64_t roomNights = report.rooms[type] * report.occupancy.days;
+            std::snprintf(line, sizeof(line), "%-7s %9.1f%% %10.2f %9.2f %9.1f%%\n",
+                          roomTypeName(static_cast<RoomType>(type)), percent(nights, roomNights),
+                          money(static_cast<double>(revenue), 1), money(static_cast<double>(revenue), roomNights),
+                          percent(static_cast<int64_t>(report.cancellations.cancelled[type]),
+                                  report.cancellations.bookings[type]));
+            std::cout << line;
+        }
+    }
+
+    void saveData() {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        std::lock_guard<std::mutex> compactLock(compactMutex);
+        if (saveLocked()) {
+            std::cout << "Data saved successfully.\n";
+        }
+    }
+
+    // Loads the snapshot and, when the hotel was empty, replays the journal
+    // written since it (after any sealed journal a crash left behind)
+    void loadData() {
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        std::lock_guard<std::mutex> compactLock(compactMutex);
+        bool recover = journal && isEmpty();
+        uint32_t loadedGeneration = 0;
+        size_t skipped = 0;
+        bool loaded = loadText(loadedGeneration, skipped);
+
+        size_t replayed = 0;
+        if (recover) {
+            uint32_t current = loadedGeneration;
+            size_t fromSealed = replayJournal(journal->getSealedPath(), current);
+            journal->sync();
+            if (journal->getGeneration() == current) {
+                replayed = fromSealed + replayJournal(journal->getPath(), current);
+            } else {
+                if (journal->getRecordCount() > 0) {
+                    std::cerr << "Warning: " << HOTEL_JOURNAL_FILE << " does not extend this save; moved it to "
+                              << HOTEL_JOURNAL_FILE << ".old without replaying.\n";
+                }
+                journal->reset(current, true);
+                replayed = fromSealed;
+            }
+            journalAttached.store(true, std::memory_order_release);
+            // The snapshot no longer matches the journal once a sealed
+            // journal has been replayed, so write a fresh one
+            if (fromSealed > 0) {
+                saveLocked();
+            }
+            std::remove(journal->getSealedPath().c_str());
+        }
+        if (!loaded && replayed == 0) {
+            std::cerr << "Error opening file for loading data.\n";
+            return;
+        }
+
+        std::cout << "Data loaded successfully.\n";
+        if (skipped > 0) {
+            std::cout << skipped << " invalid line(s) skipped.\n";
+        }
+        if (replayed > 0) {
+            std::cout << "Recovered " << replayed << " change(s) from " << HOTEL_JOURNAL_FILE << ".\n";
+        }
+    }
+};
+
+// Bounded single-producer single-consumer ring. Each side keeps a cached
+// copy of the other side's index and reloads it only when the ring looks
+// full (or empty), so the shared cache lines move only when they must.
+template <typename T>
+class SpscQueue {
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0}; // next slot to pop, written by the consumer
+    size_t cachedTail = 0;
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push, written by the producer
+    size_t cachedHead = 0;
+
+public:
+    // capacity must be a power of two
+    explicit SpscQueue(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+    bool tryPush(T&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size()) {
+                return false;
+            }
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// Requests per session and worker that may be queued at once
+const size_t SHARD_QUEUE_CAPACITY = 1024;
+
+// Filled in by the worker that runs a ShardRequest; done is set last
+struct ShardResult {
+    std::atomic<bool> done{false};
+    BookingStatus status = BookingStatus::Ok;
+    int roomNumber = 0;       // the room BookAnyRoom picked
+    std::vector<int> rooms;   // free rooms FindAvailable found
+    size_t totalMatches = 0;  // free rooms of that type in the property
+};
+
+// One operation on one property, run by the worker that owns it
+struct ShardRequest {
+    enum class Op : uint8_t { AddRoom, AddCustomer, BookRoom, BookAnyRoom, CancelBooking, FindAvailable };
+    Op op = Op::BookRoom;
+    RoomType roomType = RoomType::Single;
+    uint32_t shard = 0; // set by HotelGroup::Session::post
+    int roomNumber = 0;
+    int customerID = 0;
+    size_t limit = 0;   // FindAvailable: rooms to return
+    std::string name;   // AddCustomer
+    ShardResult* result = nullptr;
+};
+
+// A free room found by HotelGroup::Session::findAvailable
+struct AvailableRoom {
+    int propertyID;
+    int roomNumber;
+};
+
+// Several properties, each a separate non-durable Hotel owned by exactly one
+// worker thread (shard i belongs to worker i % workers), so a property's
+// rooms and bookings are only ever touched by one core. Callers open a
+// Session per thread; every session has its own SPSC queue to each worker,
+// so no queue ever has two producers. Properties are added before start().
+class HotelGroup {
+    struct Property {
+        int propertyID;
+        std::string name;
+        std::string city;
+        std::unique_ptr<Hotel> hotel;
+    };
+    std::vector<Property> properties;
+    IdIndex propertyIndex;
+    size_t workerCount;
+    size_t maxSessions;
+    std::vector<std::unique_ptr<SpscQueue<ShardRequest>>> queues; // [session * workerCount + worker]
+    std::atomic<size_t> openSessions{0};
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+
+    // Where an idle worker sleeps. It sets sleeping, looks at its queues
+    // once more and only then waits; Session::post checks sleeping after
+    // pushing, so one of the two always sees the other.
+    struct Parking {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping{false};
+    };
+    std::vector<std::unique_ptr<Parking>> parking; // [worker]
+
+    void execute(ShardRequest& request) {
+        Hotel& hotel = *properties[request.shard].hotel;
+        ShardResult& result = *request.result;
+        switch (request.op) {
+        case ShardRequest::Op::AddRoom:
+            result.status = hotel.tryAddRoom(Room(request.roomNumber, request.roomType));
+            break;
+        case ShardRequest::Op::AddCustomer:
+            result.status = hotel.tryAddCustomer(Customer(request.customerID, std::move(request.name)));
+            break;
+        case ShardRequest::Op::BookRoom:
+            result.status = hotel.tryBookRoom(request.roomNumber, request.customerID);
+            break;
+        case ShardRequest::Op::BookAnyRoom:
+            result.status = hotel.tryBookAnyRoom(request.roomType, request.customerID, result.roomNumber);
+            break;
+        case ShardRequest::Op::CancelBooking:
+            result.status = hotel.tryCancelBooking(request.roomNumber, request.customerID);
+            break;
+        case ShardRequest::Op::FindAvailable: {
+            RoomFilter filter;
+            filter.allTypes = false;
+            filter.roomType = request.roomType;
+            filter.availableOnly = true;
+            RoomPage page = hotel.listRooms(filter, 0, request.limit);
+            result.rooms.clear();
+            for (const auto& room : page.rooms) {
+                result.rooms.push_back(room.getRoomNumber());
+            }
+            result.totalMatches = page.totalMatches;
+            result.status = BookingStatus::Ok;
+            break;
+        }
+        }
+        result.done.store(true, std::memory_order_release);
+    }
+
+    // Drains this worker's queue from every open session. When idle it
+    // spins briefly, then yields, then parks until a request is posted.
+    // Once stopping is set it exits after a pass that finds nothing, so
+    // every request posted before destruction still completes.
+    void workLoop(size_t worker) {
+#ifdef __linux__
+        unsigned cores = std::thread::hardware_concurrency();
+        if (cores > 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(worker % cores, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+#endif
+        const unsigned spinRounds = 64, yieldRounds = 1024;
+        Parking& park = *parking[worker];
+        ShardRequest request;
+        unsigned idleRounds = 0;
+        while (true) {
+            bool stop = stopping.load(std::memory_order_acquire);
+            bool ran = false;
+            size_t sessions = openSessions.load(std::memory_order_acquire);
+            for (size_t session = 0; session < sessions; ++session) {
+                SpscQueue<ShardRequest>& queue = *queues[session * workerCount + worker];
+                while (queue.tryPop(request)) {
+                    execute(request);
+                    ran = true;
+                }
+            }
+            if (ran) {
+                idleRounds = 0;
+                park.sleeping.store(false, std::memory_order_relaxed);
+            } else if (stop) {
+                return;
+            } else if (++idleRounds <= spinRounds) {
+                continue;
+            } else if (idleRounds <= yieldRounds) {
+                std::this_thread::yield();
+            } else if (!park.sleeping.load(std::memory_order_relaxed)) {
+                // One more pass over the queues before actually waiting
+                park.sleeping.store(true, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            } else {
+                std::unique_lock<std::mutex> lock(park.mutex);
+                park.wake.wait(lock, [&] {
+                    return !park.sleeping.load(std::memory_order_relaxed) || stopping.load(std::memory_order_acquire);
+                });
+                park.sleeping.store(false, std::memory_order_relaxed);
+                idleRounds = 0;
+            }
+        }
+    }
+
+    // Called by Session::post after a push
+    void wakeWorker(size_t worker) {
+        Parking& park = *parking[worker];
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (park.sleeping.load(std::memory_order_relaxed) && park.sleeping.exchange(false)) {
+            std::lock_guard<std::mutex> lock(park.mutex);
+            park.wake.notify_one();
+        }
+    }
+
+public:
+    // workers of 0 means one per core
+    explicit HotelGroup(size_t workers = 0, size_t sessionLimit = 64)
+        : workerCount(workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency())),
+          maxSessions(sessionLimit) {
+        queues.reserve(maxSessions * workerCount);
+        for (size_t i = 0; i < maxSessions * workerCount; ++i) {
+            queues.emplace_back(new SpscQueue<ShardRequest>(SHARD_QUEUE_CAPACITY));
+        }
+        for (size_t i = 0; i < workerCount; ++i) {
+            parking.emplace_back(new Parking);
+        }
+    }
+
+    // Sessions must be finished with before the group is destroyed: the
+    // workers run every request already posted and then exit, and nothing
+    // may be posted after that starts.
+    ~HotelGroup() {
+        stopping.store(true, std::memory_order_release);
+        for (auto& park : parking) {
+            std::lock_guard<std::mutex> lock(park->mutex);
+            park->wake.notify_all();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    HotelGroup(const HotelGroup&) = delete;
+    HotelGroup& operator=(const HotelGroup&) = delete;
+
+    // Returns false if the ID is taken
+    bool addProperty(int propertyID, const std::string& name, const std::string& city) {
+        if (!workers.empty()) {
+            throw std::logic_error("Properties must be added before the group starts.");
+        }
+        if (!propertyIndex.insert(propertyID, static_cast<uint32_t>(properties.size()))) {
+            return false;
+        }
+        properties.push_back(Property{propertyID, name, city, std::unique_ptr<Hotel>(new Hotel(false))});
+        properties.back().hotel->setVerbose(false);
+        return true;
+    }
+
+    // Direct access for bulk setup; only valid before start()
+    Hotel* getProperty(int propertyID) {
+        uint32_t shard = propertyIndex.find(propertyID);
+        return workers.empty() && shard != IdIndex::EMPTY ? properties[shard].hotel.get() : nullptr;
+    }
+
+    size_t getPropertyCount() const { return properties.size(); }
+    size_t getWorkerCount() const { return workerCount; }
+
+    void start() {
+        for (size_t worker = 0; worker < workerCount; ++worker) {
+            workers.emplace_back([this, worker] { workLoop(worker); });
+        }
+    }
+
+    // Submits requests for one calling thread. Not thread-safe: each thread
+    // opens its own.
+    class Session {
+        HotelGroup* group;
+        size_t index;
+
+        BookingStatus run(int propertyID, ShardRequest& request) {
+            ShardResult result;
+            request.result = &result;
+            if (!post(propertyID, std::move(request))) {
+                return BookingStatus::PropertyNotFound;
+            }
+            wait(result);
+            return result.status;
+        }
+
+    public:
+        Session(HotelGroup& group, size_t index) : group(&group), index(index) {}
+
+        // Queues the request for the property's worker and returns at once;
+        // request.result must stay alive until wait() returns for it. Returns
+        // false, queuing nothing, for an unknown property.
+        bool post(int propertyID, ShardRequest&& request) {
+            uint32_t shard = group->propertyIndex.find(propertyID);
+            if (shard == IdIndex::EMPTY) {
+                return false;
+            }
+            request.shard = shard;
+            size_t worker = shard % group->workerCount;
+            SpscQueue<ShardRequest>& queue = *group->queues[index * group->workerCount + worker];
+            while (!queue.tryPush(std::move(request))) {
+                std::this_thread::yield();
+            }
+            group->wakeWorker(worker);
+            return true;
+        }
+
+        static void wait(const ShardResult& result) {
+            for (unsigned spins = 0; !result.done.load(std::memory_order_acquire); ++spins) {
+                if (spins > 64) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        BookingStatus addRoom(int propertyID, const Room& room) {
+            ShardRequest request;
+            request.op = ShardRequest::Op::AddRoom;
+            request.roomNumber = room.getRoomNumber();
+            request.roomType = room.getRoomType();
+            return run(propertyID, request);
+        }
+
+        BookingStatus addCustomer(int propertyID, int customerID, const std::string& name) {
+            ShardRequest request;
+            request.op = ShardRequest::Op::AddCustomer;
+            request.customerID = customerID;
+            request.name = name;
+            return run(propertyID, request);
+        }
+
+        BookingStatus bookRoom(int propertyID, int roomNumber, int customerID) {
+            ShardRequest request;
+            request.op = ShardRequest::Op::BookRoom;
+            request.roomNumber = roomNumber;
+            request.customerID = customerID;
+            return run(propertyID, request);
+        }
+
+        BookingStatus bookAnyRoom(int propertyID, RoomType roomType, int customerID, int& roomNumber) {
+            ShardResult result;
+            ShardRequest request;
+            request.op = ShardRequest::Op::BookAnyRoom;
+            request.roomType = roomType;
+            request.customerID = customerID;
+            request.result = &result;
+            if (!post(propertyID, std::move(request))) {
+                return BookingStatus::PropertyNotFound;
+            }
+            wait(result);
+            roomNumber = result.roomNumber;
+            return result.status;
+        }
+
+        BookingStatus cancelBooking(int propertyID, int roomNumber, int customerID) {
+            ShardRequest request;
+            request.op = ShardRequest::Op::CancelBooking;
+            request.roomNumber = roomNumber;
+            request.customerID = customerID;
+            return run(propertyID, request);
+        }
+
+        // Free rooms of the type in every property in the city, at most
+        // limitPerProperty from each. The properties are searched in
+        // parallel by their workers; results are ordered by property as
+        // added. totalMatches, if given, receives the number of free rooms
+        // across all of them.
+        std::vector<AvailableRoom> findAvailable(std::string_view city, RoomType roomType,
+                                                 size_t limitPerProperty, size_t* totalMatches = nullptr) {
+            std::vector<uint32_t> shards;
+            for (size_t shard = 0; shard < group->properties.size(); ++shard) {
+                if (group->properties[shard].city == city) {
+                    shards.push_back(static_cast<uint32_t>(shard));
+                }
+            }
+            std::vector<ShardResult> results(shards.size());
+            for (size_t i = 0; i < shards.size(); ++i) {
+                ShardRequest request;
+                request.op = ShardRequest::Op::FindAvailable;
+                request.roomType = roomType;
+                request.limit = limitPerProperty;
+                request.result = &results[i];
+                post(group->properties[shards[i]].propertyID, std::move(request));
+            }
+
+            std::vector<AvailableRoom> rooms;
+            size_t total = 0;
+            for (size_t i = 0; i < shards.size(); ++i) {
+                wait(results[i]);
+                for (int roomNumber : results[i].rooms) {
+                    rooms.push_back(AvailableRoom{group->properties[shards[i]].propertyID, roomNumber});
+                }
+                total += results[i].totalMatches;
+            }
+            if (totalMatches) {
+                *totalMatches = total;
+            }
+            return rooms;
+        }
+    };
+
+    // Throws once maxSessions sessions have been opened
+    Session openSession() {
+        size_t index = openSessions.load(std::memory_order_relaxed);
+        do {
+            if (index >= maxSessions) {
+                throw std::runtime_error("Too many HotelGroup sessions.");
+            }
+        } while (!openSessions.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+        return Session(*this, index);
+    }
+};
+
+#ifdef __linux__
+// Server mode (Linux only): the hotel is served over a Unix domain socket
+// ("unix:PATH") or loopback TCP ("PORT") by one or more single-threaded
+// epoll loops. Every message is
+//   uint32 length | body
+// in native byte order, where length counts the body. A request body is
+//   uint8 op | arguments (int32s; a string is an int32 length and its bytes)
+// and a response body is
+//   uint8 status | results (int32s)
+// with status a BookingStatus, or STATUS_BAD_REQUEST. Each connection gets
+// its responses in request order, so a client may pipeline any number of
+// requests without waiting for earlier ones.
+//   ADD_ROOM      room, type       -> status
+//   ADD_CUSTOMER  id, name         -> status
+//   HAS_CUSTOMER  id               -> status (CustomerNotFound if missing)
+//   BOOK          room, customer   -> status
+//   BOOK_ANY      type, customer   -> status, room
+//   CANCEL        room, customer   -> status
+//   AVAILABILITY                   -> status, available and occupied per room type
+enum class RequestOp : uint8_t { AddRoom = 1, AddCustomer = 2, HasCustomer = 3, Book = 4, BookAny = 5, Cancel = 6,
+                                 Availability = 7 };
+const uint8_t STATUS_BAD_REQUEST = 255;
+
+// Longest request body accepted; a longer one closes the connection
+const size_t MAX_REQUEST_SIZE = 4096;
+
+// A client with this much unsent output is not read from until it catches up
+const size_t MAX_PENDING_OUTPUT = 1 << 20;
+
+// Set by SIGINT/SIGTERM; the loops notice within SERVER_POLL_MS
+std::atomic<bool> serverStopping{false};
+const int SERVER_POLL_MS = 200;
+
+extern "C" void stopServer(int) { serverStopping = true; }
+
+struct ServerAddress {
+    bool isUnix = false;
+    std::string path;  // Unix socket path
+    uint16_t port = 0; // loopback TCP port
 };
 
-// Booking Class
-class Booking {
-    int roomNumber;
-    int customerID;
-    bool isActive;
+inline bool parseAddress(std::string_view text, ServerAddress& address) {
+    if (text.compare(0, 5, "unix:") == 0) {
+        address.isUnix = true;
+        address.path = std::string(text.substr(5));
+        return !address.path.empty() && address.path.size() < sizeof(sockaddr_un::sun_path);
+    }
+    int port;
+    if (!parseInt(text, port) || port <= 0 || port > 65535) {
+        return false;
+    }
+    address.port = static_cast<uint16_t>(port);
+    return true;
+}
 
-public:
-    Booking(int roomNumber, int customerID) : roomNumber(roomNumber), customerID(customerID), isActive(true) {}
+// Fills in the socket address; returns its length
+inline socklen_t socketAddress(const ServerAddress& address, sockaddr_storage& storage) {
+    std::memset(&storage, 0, sizeof(storage));
+    if (address.isUnix) {
+        sockaddr_un* local = reinterpret_cast<sockaddr_un*>(&storage);
+        local->sun_family = AF_UNIX;
+        std::memcpy(local->sun_path, address.path.data(), address.path.size());
+        return sizeof(sockaddr_un);
+    }
+    sockaddr_in* loopback = reinterpret_cast<sockaddr_in*>(&storage);
+    loopback->sin_family = AF_INET;
+    loopback->sin_port = htons(address.port);
+    loopback->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return sizeof(sockaddr_in);
+}
 
-    int getRoomNumber() const { return roomNumber; }
-    int getCustomerID() const { return customerID; }
-    bool getStatus() const { return isActive; }
+// Non-blocking listening socket, or -1. With reusePort several sockets can
+// listen on the same TCP port and the kernel spreads connections over them.
+inline int openListener(const ServerAddress& address, bool reusePort) {
+    int fd = ::socket(address.isUnix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int on = 1;
+    if (!address.isUnix) {
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (reusePort) {
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+        }
+    }
+    sockaddr_storage storage;
+    socklen_t length = socketAddress(address, storage);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
 
-    void cancelBooking() { isActive = false; }
-};
+// Blocking client socket, or -1
+inline int connectTo(const ServerAddress& address) {
+    int fd = ::socket(address.isUnix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_storage storage;
+    socklen_t length = socketAddress(address, storage);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&storage), length) < 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    if (!address.isUnix) {
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
 
-// Hotel Class
-class Hotel {
-    std::vector<Room*> rooms;
-    std::vector<Customer> customers;
-    std::vector<Booking> bookings;
+// Builds length-prefixed messages in an output buffer
+class MessageWriter {
+    std::vector<char>& out;
+    size_t start;
 
 public:
-    ~Hotel() {
-        for (auto room : rooms) {
-            delete room;
-        }
+    explicit MessageWriter(std::vector<char>& buffer) : out(buffer), start(buffer.size()) {
+        out.resize(start + sizeof(uint32_t));
     }
 
-    void addRoom(Room* room) {
-        rooms.push_back(room);
+    MessageWriter& putByte(uint8_t value) {
+        out.push_back(static_cast<char>(value));
+        return *this;
     }
 
-    void addCustomer(const Customer& customer) {
-        customers.push_back(customer);
+    MessageWriter& putInt(int32_t value) {
+        const char* raw = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), raw, raw + sizeof(value));
+        return *this;
     }
 
-    bool customerExists(int customerID) const {
-        for (const auto& customer : customers) {
-            if (customer.getID() == customerID) {
-                return true;
-            }
-        }
-        return false;
+    MessageWriter& putString(std::string_view text) {
+        putInt(static_cast<int32_t>(text.size()));
+        out.insert(out.end(), text.begin(), text.end());
+        return *this;
     }
 
-    void showCustomers() const {
-        std::cout << "\nList of Customers:\n";
-        for (const auto& customer : customers) {
-            std::cout << "Customer ID: " << customer.getID() << " | Name: " << customer.getName() << std::endl;
-        }
+    // Fills in the length prefix
+    ~MessageWriter() {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+        std::memcpy(out.data() + start, &length, sizeof(length));
     }
+};
 
-    void bookRoom(int roomNumber, int customerID) {
-        if (!customerExists(customerID)) {
-            std::cerr << "Error: Customer ID " << customerID << " does not exist.\n";
-            return;
+// Calls handle(body, size) for each complete message at the front of input
+// and erases them. Returns false if a message is longer than maxSize.
+template <typename Handle>
+bool takeMessages(std::vector<char>& input, size_t maxSize, Handle handle) {
+    size_t pos = 0;
+    while (input.size() - pos >= sizeof(uint32_t)) {
+        uint32_t length;
+        std::memcpy(&length, input.data() + pos, sizeof(length));
+        if (length == 0 || length > maxSize) {
+            return false;
+        }
+        if (input.size() - pos - sizeof(uint32_t) < length) {
+            break;
         }
+        handle(input.data() + pos + sizeof(uint32_t), static_cast<size_t>(length));
+        pos += sizeof(uint32_t) + length;
+    }
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(pos));
+    return true;
+}
 
-        for (auto& room : rooms) {
-            if (room->getRoomNumber() == roomNumber) {
-                if (room->getAvailability()) {
-                    room->setAvailability(false);
-                    bookings.push_back(Booking(roomNumber, customerID));
-                    std::cout << "Room " << roomNumber << " booked successfully for Customer ID " << customerID << ".\n";
-                    return;
-                } else {
-                    throw std::runtime_error("Room is not available.");
+// One epoll loop. It accepts connections from its listening socket and
+// answers their requests; loops share nothing but the Hotel, whose booking
+// calls are safe to make concurrently. Sockets are level-triggered: each
+// readable connection gets one read per wakeup, every complete request in
+// it is answered, and the answers go out in a single write.
+class ServerLoop {
+    struct Connection {
+        std::vector<char> input;
+        std::vector<char> output;
+        size_t sent = 0;      // bytes of output already written
+        bool reading = true;  // EPOLLIN registered; dropped while output backs up
+        bool writing = false; // EPOLLOUT registered
+    };
+
+    Hotel& hotel;
+    int listenFd;
+    int epollFd = -1;
+    std::vector<std::unique_ptr<Connection>> connections; // by file descriptor
+    uint64_t requestCount = 0;
+
+    void closeConnection(int fd) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections[fd].reset();
+    }
+
+    void acceptAll() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
                 }
+                return; // EAGAIN, or out of descriptors until some close
             }
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails harmlessly on Unix sockets
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                ::close(fd);
+                continue;
+            }
+            if (static_cast<size_t>(fd) >= connections.size()) {
+                connections.resize(fd + 1);
+            }
+            connections[fd].reset(new Connection());
         }
-        throw std::runtime_error("Room not found.");
     }
 
-    void cancelBooking(int roomNumber, int customerID) {
-        for (auto& booking : bookings) {
-            if (booking.getRoomNumber() == roomNumber && booking.getCustomerID() == customerID && booking.getStatus()) {
-                booking.cancelBooking();
-                for (auto& room : rooms) {
-                    if (room->getRoomNumber() == roomNumber) {
-                        room->setAvailability(true);
-                        std::cout << "Booking canceled successfully.\n";
-                        return;
-                    }
-                }
+    // Appends the response to one request
+    void handleRequest(const char* body, size_t size, std::vector<char>& output) {
+        Journal::Cursor args(body + 1, size - 1);
+        int32_t first, second;
+        std::string_view name;
+        uint8_t status = STATUS_BAD_REQUEST;
+        int32_t results[2 * ROOM_TYPE_COUNT];
+        size_t resultCount = 0;
+        auto validType = [](int32_t type) { return type >= 0 && static_cast<size_t>(type) < ROOM_TYPE_COUNT; };
+        switch (static_cast<RequestOp>(body[0])) {
+        case RequestOp::AddRoom:
+            if (args.getInt(first) && args.getInt(second) && validType(second)) {
+                status = static_cast<uint8_t>(hotel.tryAddRoom(Room(first, static_cast<RoomType>(second))));
+            }
+            break;
+        case RequestOp::AddCustomer:
+            if (args.getInt(first) && args.getString(name)) {
+                status = static_cast<uint8_t>(hotel.tryAddCustomer(Customer(first, std::string(name))));
+            }
+            break;
+        case RequestOp::HasCustomer:
+            if (args.getInt(first)) {
+                status = static_cast<uint8_t>(hotel.customerExists(first) ? BookingStatus::Ok
+                                                                          : BookingStatus::CustomerNotFound);
+            }
+            break;
+        case RequestOp::Book:
+            if (args.getInt(first) && args.getInt(second)) {
+                status = static_cast<uint8_t>(hotel.tryBookRoom(first, second));
+            }
+            break;
+        case RequestOp::BookAny:
+            if (args.getInt(first) && args.getInt(second) && validType(first)) {
+                int roomNumber = -1;
+                status = static_cast<uint8_t>(hotel.tryBookAnyRoom(static_cast<RoomType>(first), second, roomNumber));
+                results[resultCount++] = roomNumber;
+            }
+            break;
+        case RequestOp::Cancel:
+            if (args.getInt(first) && args.getInt(second)) {
+                status = static_cast<uint8_t>(hotel.tryCancelBooking(first, second));
+            }
+            break;
+        case RequestOp::Availability:
+            for (const auto& type : hotel.getOccupancy()) {
+                results[resultCount++] = static_cast<int32_t>(type.available);
+                results[resultCount++] = static_cast<int32_t>(type.occupied);
             }
+            status = static_cast<uint8_t>(BookingStatus::Ok);
+            break;
+        }
+        MessageWriter response(output);
+        response.putByte(status);
+        for (size_t i = 0; i < resultCount; ++i) {
+            response.putInt(results[i]);
         }
-        throw std::runtime_error("Booking not found or already canceled.");
     }
 
-    void checkAvailability() const {
-        std::cout << "\nRoom Availability:\n";
-        for (const auto& room : rooms) {
-            room->displayDetails();
+    // Writes as much pending output as the socket takes, then registers for
+    // the events the connection now needs
+    void flush(int fd, Connection& connection) {
+        while (connection.sent < connection.output.size()) {
+            ssize_t written = ::send(fd, connection.output.data() + connection.sent,
+                                     connection.output.size() - connection.sent, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                closeConnection(fd);
+                return;
+            }
+            connection.sent += static_cast<size_t>(written);
+        }
+        if (connection.sent == connection.output.size()) {
+            connection.output.clear();
+            connection.sent = 0;
+        }
+        bool writing = !connection.output.empty();
+        bool reading = connection.output.size() - connection.sent < MAX_PENDING_OUTPUT;
+        if (writing != connection.writing || reading != connection.reading) {
+            epoll_event event{};
+            event.events = (reading ? uint32_t(EPOLLIN) : 0u) | (writing ? uint32_t(EPOLLOUT) : 0u);
+            event.data.fd = fd;
+            ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+            connection.writing = writing;
+            connection.reading = reading;
         }
     }
 
-    void saveData() {
-        std::ofstream file("hotel_data.txt");
-        if (!file) {
-            std::cerr << "Error opening file for saving data.\n";
+    void onReadable(int fd, Connection& connection) {
+        const size_t READ_SIZE = 64 * 1024;
+        size_t used = connection.input.size();
+        connection.input.resize(used + READ_SIZE);
+        ssize_t received = ::read(fd, connection.input.data() + used, READ_SIZE);
+        connection.input.resize(used + (received > 0 ? static_cast<size_t>(received) : 0));
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeConnection(fd);
+            return;
+        }
+        bool valid = takeMessages(connection.input, MAX_REQUEST_SIZE, [&](const char* body, size_t size) {
+            handleRequest(body, size, connection.output);
+            ++requestCount;
+        });
+        if (!valid) {
+            closeConnection(fd);
             return;
         }
+        flush(fd, connection);
+    }
 
-        // Save rooms
-        file << "Rooms:\n";
-        for (const auto& room : rooms) {
-            file << room->getRoomNumber() << "|" << room->getRoomType() << "|" 
-                 << (room->getAvailability() ? "1" : "0") << "\n";
+public:
+    ServerLoop(Hotel& hotel, int listenFd) : hotel(hotel), listenFd(listenFd) {}
+
+    ~ServerLoop() {
+        for (size_t fd = 0; fd < connections.size(); ++fd) {
+            if (connections[fd]) {
+                ::close(static_cast<int>(fd));
+            }
         }
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+    }
 
-        // Save customers
-        file << "Customers:\n";
-        for (const auto& customer : customers) {
-            file << customer.getID() << "|" << customer.getName() << "\n";
+    ServerLoop(const ServerLoop&) = delete;
+    ServerLoop& operator=(const ServerLoop&) = delete;
+
+    uint64_t getRequestCount() const { return requestCount; }
+
+    // Serves until serverStopping is set
+    bool run() {
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+        event.events |= EPOLLEXCLUSIVE; // loops sharing a Unix listener are not all woken per connection
+#endif
+        event.data.fd = listenFd;
+        if (epollFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+            std::cerr << "Error: cannot start event loop: " << std::strerror(errno) << "\n";
+            return false;
         }
 
-        // Save bookings
-        file << "Bookings:\n";
-        for (const auto& booking : bookings) {
-            file << booking.getRoomNumber() << "|" << booking.getCustomerID() 
-                 << "|" << (booking.getStatus() ? "1" : "0") << "\n";
+        const int MAX_EVENTS = 256;
+        epoll_event events[MAX_EVENTS];
+        while (!serverStopping) {
+            int ready = ::epoll_wait(epollFd, events, MAX_EVENTS, SERVER_POLL_MS);
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptAll();
+                    continue;
+                }
+                // A connection closed earlier in this batch is gone
+                if (static_cast<size_t>(fd) >= connections.size() || !connections[fd]) {
+                    continue;
+                }
+                Connection& connection = *connections[fd];
+                if (events[i].events & EPOLLOUT) {
+                    flush(fd, connection);
+                }
+                if (connections[fd] && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    onReadable(fd, connection);
+                }
+            }
         }
+        return true;
+    }
+};
 
-        file.close();
-        std::cout << "Data saved successfully.\n";
+// Serves the hotel with the given number of event loops until SIGINT or
+// SIGTERM; returns the exit code. TCP loops each get their own listener on
+// the port (SO_REUSEPORT); on a Unix socket they share one.
+int runServer(Hotel& hotel, const ServerAddress& address, int loops) {
+    hotel.setVerbose(false);
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // A socket file left behind by an earlier run would make bind fail
+    struct stat existing;
+    if (address.isUnix && ::stat(address.path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        ::unlink(address.path.c_str());
     }
 
-    void loadData() {
-        std::ifstream file("hotel_data.txt");
-        if (!file) {
-            std::cerr << "Error opening file for loading data.\n";
-            return;
+    std::string name = address.isUnix ? address.path : "127.0.0.1:" + std::to_string(address.port);
+    std::vector<int> listeners;
+    for (int i = 0; i < (address.isUnix ? 1 : loops); ++i) {
+        int fd = openListener(address, loops > 1);
+        if (fd < 0) {
+            std::cerr << "Error: cannot listen on " << name << ": " << std::strerror(errno) << "\n";
+            for (int open : listeners) {
+                ::close(open);
+            }
+            return 1;
         }
+        listeners.push_back(fd);
+    }
 
-        std::string line;
-        enum Section { NONE, ROOMS, CUSTOMERS, BOOKINGS };
-        Section currentSection = NONE;
+    std::vector<std::unique_ptr<ServerLoop>> servers;
+    for (int i = 0; i < loops; ++i) {
+        servers.emplace_back(new ServerLoop(hotel, listeners[i % listeners.size()]));
+    }
+    std::cout << "Serving on " << name << " with " << loops << " event loop(s). Press Ctrl+C to stop." << std::endl;
 
-        while (std::getline(file, line)) {
-            if (line == "Rooms:") {
-                currentSection = ROOMS;
-                continue;
-            } else if (line == "Customers:") {
-                currentSection = CUSTOMERS;
-                continue;
-            } else if (line == "Bookings:") {
-                currentSection = BOOKINGS;
-                continue;
-            }
+    std::vector<std::thread> threads;
+    for (int i = 1; i < loops; ++i) {
+        threads.emplace_back([&servers, i] { servers[i]->run(); });
+    }
+    bool ok = servers[0]->run();
+    serverStopping = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-            if (currentSection == ROOMS) {
-                // Parse room data
-                int roomNumber;
-                std::string roomType;
-                bool isAvailable;
+    uint64_t requests = 0;
+    for (const auto& server : servers) {
+        requests += server->getRequestCount();
+    }
+    servers.clear();
+    for (int fd : listeners) {
+        ::close(fd);
+    }
+    if (address.isUnix) {
+        ::unlink(address.path.c_str());
+    }
+    std::cout << "Stopped after " << requests << " request(s)." << std::endl;
+    return ok ? 0 : 1;
+}
 
-                size_t pos1 = line.find('|');
-                size_t pos2 = line.find('|', pos1 + 1);
-                size_t pos3 = line.find('|', pos2 + 1);
+// Room and customer numbers the load generator uses; each connection books
+// its own block of rooms so its bookings never collide with another's
+const int LOADGEN_ROOM_BASE = 1000000;
+const int LOADGEN_ROOMS_PER_CONNECTION = 1024;
+const int LOADGEN_CUSTOMER_BASE = 1000000;
 
-                roomNumber = std::stoi(line.substr(0, pos1));
-                roomType = line.substr(pos1 + 1, pos2 - pos1 - 1);
-                isAvailable = line.substr(pos3 + 1) == "1";
+// Load generator (--loadgen): opens connections, each on its own thread with
+// depth requests in flight, and has each book and cancel rooms of its own
+// block (with an availability query every 16 requests) for the given number
+// of seconds. It first adds the rooms and one customer per connection;
+// ones left by an earlier run are reused. Latency is measured from writing
+// a request to reading its response. Returns the exit code.
+int runLoadGen(const ServerAddress& address, int connections, int depth, int seconds) {
+    using Clock = std::chrono::steady_clock;
+    std::signal(SIGPIPE, SIG_IGN);
+    struct Result {
+        std::vector<uint32_t> latencies; // nanoseconds
+        uint64_t failed = 0;
+        bool connected = false;
+    };
+    std::vector<Result> results(connections);
 
-                if (roomType == "Single") {
-                    rooms.push_back(new SingleRoom(roomNumber));
-                } else if (roomType == "Double") {
-                    rooms.push_back(new DoubleRoom(roomNumber));
-                } else if (roomType == "Suite") {
-                    rooms.push_back(new SuiteRoom(roomNumber));
-                }
-                rooms.back()->setAvailability(isAvailable);
+    // The measured run starts once every connection has finished its setup
+    std::atomic<int> ready{0};
+    std::atomic<bool> started{false};
+    Clock::time_point loadStart;
+    auto waitForAll = [&]() {
+        if (ready.fetch_add(1) + 1 == connections) {
+            loadStart = Clock::now();
+            started.store(true, std::memory_order_release);
+        }
+        while (!started.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    };
 
-            } else if (currentSection == CUSTOMERS) {
-                // Parse customer data
-                int customerID;
-                std::string name;
+    auto drive = [&](int index) {
+        Result& result = results[index];
+        int fd = connectTo(address);
+        int customerID = LOADGEN_CUSTOMER_BASE + index;
+        int firstRoom = LOADGEN_ROOM_BASE + index * LOADGEN_ROOMS_PER_CONNECTION;
+        std::vector<char> output, input;
+        auto sendAll = [&]() {
+            bool ok = writeFully(fd, output.data(), output.size());
+            output.clear();
+            return ok;
+        };
+        // Waits for data and passes each complete response, with the time it
+        // arrived, to onResponse
+        auto readResponses = [&](auto onResponse) {
+            size_t used = input.size();
+            input.resize(used + 64 * 1024);
+            ssize_t received = ::read(fd, input.data() + used, 64 * 1024);
+            input.resize(used + (received > 0 ? static_cast<size_t>(received) : 0));
+            Clock::time_point now = Clock::now();
+            return received > 0 && takeMessages(input, MAX_REQUEST_SIZE, [&](const char* body, size_t) {
+                onResponse(static_cast<uint8_t>(body[0]), now);
+            });
+        };
 
-                size_t pos = line.find('|');
-                customerID = std::stoi(line.substr(0, pos));
-                name = line.substr(pos + 1);
+        // Setup, pipelined in one write
+        bool ok = fd >= 0;
+        if (ok) {
+            MessageWriter(output).putByte(static_cast<uint8_t>(RequestOp::AddCustomer)).putInt(customerID)
+                .putString("Load generator " + std::to_string(index));
+            for (int i = 0; i < LOADGEN_ROOMS_PER_CONNECTION; ++i) {
+                MessageWriter(output).putByte(static_cast<uint8_t>(RequestOp::AddRoom)).putInt(firstRoom + i)
+                    .putInt(i % static_cast<int>(ROOM_TYPE_COUNT));
+            }
+            size_t expected = LOADGEN_ROOMS_PER_CONNECTION + 1;
+            ok = sendAll();
+            while (ok && expected > 0) {
+                ok = readResponses([&](uint8_t, Clock::time_point) { --expected; });
+            }
+        }
+        result.connected = ok;
+        waitForAll();
+        if (!ok) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return;
+        }
 
-                customers.push_back(Customer(customerID, name));
+        // Requests cycle through book room r, cancel room r, with an
+        // availability query every 16th request
+        Clock::time_point deadline = loadStart + std::chrono::seconds(seconds);
+        uint64_t sequence = 0;
+        auto queueRequest = [&]() {
+            uint64_t n = sequence++;
+            if (n % 16 == 15) {
+                MessageWriter(output).putByte(static_cast<uint8_t>(RequestOp::Availability));
+                return;
+            }
+            uint64_t pair = n - n / 16; // position among the book/cancel requests
+            int room = firstRoom + static_cast<int>((pair / 2) % LOADGEN_ROOMS_PER_CONNECTION);
+            RequestOp op = pair % 2 == 0 ? RequestOp::Book : RequestOp::Cancel;
+            MessageWriter(output).putByte(static_cast<uint8_t>(op)).putInt(room).putInt(customerID);
+        };
 
-            } else if (currentSection == BOOKINGS) {
-                // Parse booking data
-                int roomNumber, customerID;
-                bool isActive;
+        std::vector<Clock::time_point> sentAt(depth); // ring buffer in request order
+        size_t head = 0, inFlight = 0;
+        auto sendBatch = [&](size_t count) {
+            Clock::time_point now = Clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                queueRequest();
+                sentAt[(head + inFlight + i) % depth] = now;
+            }
+            inFlight += count;
+            return sendAll();
+        };
 
-                size_t pos1 = line.find('|');
-                size_t pos2 = line.find('|', pos1 + 1);
+        // Each response frees a slot for a new request until the deadline;
+        // after it the loop only drains what is in flight
+        ok = sendBatch(depth);
+        while (ok && inFlight > 0) {
+            size_t arrived = 0;
+            ok = readResponses([&](uint8_t status, Clock::time_point now) {
+                int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - sentAt[head]).count();
+                result.latencies.push_back(static_cast<uint32_t>(std::min<int64_t>(latency, UINT32_MAX)));
+                result.failed += status != static_cast<uint8_t>(BookingStatus::Ok);
+                head = (head + 1) % depth;
+                --inFlight;
+                ++arrived;
+            });
+            if (ok && arrived > 0 && Clock::now() < deadline) {
+                ok = sendBatch(arrived);
+            }
+        }
+        ::close(fd);
+    };
 
-                roomNumber = std::stoi(line.substr(0, pos1));
-                customerID = std::stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
-                isActive = line.substr(pos2 + 1) == "1";
+    std::vector<std::thread> threads;
+    for (int i = 0; i < connections; ++i) {
+        threads.emplace_back(drive, i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - loadStart).count();
 
-                bookings.push_back(Booking(roomNumber, customerID));
-                if (!isActive) {
-                    bookings.back().cancelBooking();
+    std::vector<uint32_t> latencies;
+    uint64_t failed = 0;
+    int connected = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        failed += result.failed;
+        connected += result.connected;
+    }
+    if (latencies.empty()) {
+        std::cerr << "Error: no responses (" << connected << " of " << connections << " connection(s) set up).\n";
+        return 1;
+    }
+    auto percentile = [&](double fraction) {
+        size_t rank = std::min(latencies.size() - 1, static_cast<size_t>(fraction * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+        return latencies[rank] / 1000.0;
+    };
+    std::cout << "loadgen: " << connected << " connection(s) x " << depth << " in flight, " << elapsed << " s\n"
+              << "  requests:   " << latencies.size() << " (" << failed << " not OK)\n"
+              << "  throughput: " << static_cast<uint64_t>(latencies.size() / elapsed) << " requests/s\n"
+              << "  latency:    p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, p999 "
+              << percentile(0.999) << " us\n";
+    return 0;
+}
+#endif
+
+// Stress mode: threads book and cancel walk-ins (by room and by type), group
+// bookings and reservations of one small hotel at once, so most requests
+// contend for the same rooms. Afterwards the booking state is cross-checked
+// and the bookings each thread saw succeed are matched against the hotel's
+// occupancy. Nothing is journaled or saved. Returns 0 if everything agrees.
+int runStress(size_t threadCount, size_t opsPerThread) {
+    const int ROOMS = 48, CUSTOMERS = 32, FIRST_ROOM = 101;
+    Hotel hotel(false);
+    hotel.setVerbose(false);
+    for (int i = 0; i < ROOMS; ++i) {
+        hotel.addRoom(Room(FIRST_ROOM + i, static_cast<RoomType>(i % ROOM_TYPE_COUNT)));
+    }
+    for (int id = 1; id <= CUSTOMERS; ++id) {
+        hotel.addCustomer(Customer(id, "Customer " + std::to_string(id)));
+    }
+
+    // unexpected counts cancellations of a thread's own bookings that
+    // failed and cancellations for a customer with no bookings that succeeded
+    std::atomic<uint64_t> booked{0}, cancelled{0}, heldRooms{0}, unexpected{0};
+    int firstDay = today() + 1;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 random(static_cast<uint32_t>(t + 1));
+            auto pick = [&random](int count) { return static_cast<int>(random() % count); };
+            // Bookings this thread made and has not cancelled; only it cancels them
+            std::vector<std::pair<int, int>> walkIns;     // room, customer
+            std::vector<std::pair<int, int>> groups;      // group ID, customer
+            std::vector<size_t> groupSizes;               // parallel to groups
+            std::vector<std::array<int, 3>> reservations; // room, customer, check-in
+            uint64_t books = 0, cancels = 0, wrong = 0;
+            for (size_t op = 0; op < opsPerThread; ++op) {
+                int customerID = pick(CUSTOMERS) + 1;
+                switch (pick(16)) {
+                case 0:
+                case 1:
+                case 2:
+                case 3:
+                case 4: {
+                    int roomNumber = FIRST_ROOM + pick(ROOMS);
+                    if (hotel.tryBookRoom(roomNumber, customerID) == BookingStatus::Ok) {
+                        walkIns.emplace_back(roomNumber, customerID);
+                        ++books;
+                    }
+                    break;
+                }
+                case 5:
+                case 6: {
+                    int roomNumber;
+                    RoomType type = static_cast<RoomType>(pick(ROOM_TYPE_COUNT));
+                    if (hotel.tryBookAnyRoom(type, customerID, roomNumber) == BookingStatus::Ok) {
+                        walkIns.emplace_back(roomNumber, customerID);
+                        ++books;
+                    }
+                    break;
+                }
+                case 7:
+                case 8:
+                case 9:
+                case 10:
+                    if (!walkIns.empty()) {
+                        size_t i = random() % walkIns.size();
+                        wrong += hotel.tryCancelBooking(walkIns[i].first, walkIns[i].second) != BookingStatus::Ok;
+                        walkIns[i] = walkIns.back();
+                        walkIns.pop_back();
+                        ++cancels;
+                    }
+                    break;
+                case 11:
+                    // A customer with no bookings: must be refused
+                    wrong += hotel.tryCancelBooking(FIRST_ROOM + pick(ROOMS), CUSTOMERS + 1) == BookingStatus::Ok;
+                    break;
+                case 12: {
+                    std::vector<int> roomNumbers;
+                    int first = pick(ROOMS), count = 2 + pick(2);
+                    for (int i = 0; i < count; ++i) {
+                        roomNumbers.push_back(FIRST_ROOM + (first + i * 7) % ROOMS);
+                    }
+                    try {
+                        groups.emplace_back(hotel.bookRooms(customerID, roomNumbers), customerID);
+                        groupSizes.push_back(roomNumbers.size());
+                        ++books;
+                    } catch (const std::runtime_error&) {
+                        // Some room was taken
+                    }
+                    break;
+                }
+                case 13:
+                    if (!groups.empty()) {
+                        size_t i = random() % groups.size();
+                        try {
+                            hotel.cancelGroupBooking(groups[i].first, groups[i].second);
+                        } catch (const std::runtime_error&) {
+                            ++wrong;
+                        }
+                        groups[i] = groups.back();
+                        groups.pop_back();
+                        groupSizes[i] = groupSizes.back();
+                        groupSizes.pop_back();
+                        ++cancels;
+                    }
+                    break;
+                case 14: {
+                    std::array<int, 3> stay = {FIRST_ROOM + pick(ROOMS), customerID, firstDay + pick(60)};
+                    try {
+                        hotel.reserveRoom(stay[0], stay[1], stay[2], stay[2] + 1 + pick(3));
+                        reservations.push_back(stay);
+                        ++books;
+                    } catch (const std::runtime_error&) {
+                        // Overlaps another reservation
+                    }
+                    break;
+                }
+                default:
+                    if (!reservations.empty()) {
+                        size_t i = random() % reservations.size();
+                        try {
+                            hotel.cancelReservation(reservations[i][0], reservations[i][1], reservations[i][2]);
+                        } catch (const std::runtime_error&) {
+                            ++wrong;
+                        }
+                        reservations[i] = reservations.back();
+                        reservations.pop_back();
+                        ++cancels;
+                    }
+                    hotel.getOccupancy();
+                    break;
                 }
             }
-        }
+            size_t held = walkIns.size();
+            for (size_t size : groupSizes) {
+                held += size;
+            }
+            booked += books;
+            cancelled += cancels;
+            heldRooms += held;
+            unexpected += wrong;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-        file.close();
-        std::cout << "Data loaded successfully.\n";
+    size_t problems = hotel.checkConsistency();
+    if (unexpected > 0) {
+        std::cerr << "Inconsistent: " << unexpected << " cancellation(s) got the wrong answer.\n";
+        ++problems;
     }
-};
+    uint64_t occupied = 0;
+    for (const RoomTypeOccupancy& occupancy : hotel.getOccupancy()) {
+        occupied += occupancy.occupied;
+    }
+    if (occupied != heldRooms) {
+        std::cerr << "Inconsistent: threads hold " << heldRooms << " rooms, but " << occupied
+                  << " are occupied.\n";
+        ++problems;
+    }
+    std::cerr << "stress: " << threadCount << " threads, " << threadCount * opsPerThread << " ops, " << booked
+              << " booked, " << cancelled << " cancelled, " << seconds << " s, "
+              << (problems == 0 ? "consistent" : std::to_string(problems) + " problem(s)") << "\n";
+    return problems == 0 ? 0 : 1;
+}
 
 // Main Function with Console Interface
-int main() {
+int main(int argc, char* argv[]) {
+#ifdef __linux__
+    // --serve ADDRESS [LOOPS] / --loadgen ADDRESS [CONNECTIONS] [DEPTH] [SECONDS],
+    // where ADDRESS is a loopback TCP port or unix:PATH
+    std::string mode = argc >= 2 ? argv[1] : "";
+    if (mode == "--serve" || mode == "--loadgen") {
+        ServerAddress address;
+        std::vector<int> counts;
+        bool valid = argc >= 3 && parseAddress(argv[2], address);
+        for (int i = 3; valid && i < argc; ++i) {
+            int count;
+            valid = parseInt(argv[i], count) && count > 0;
+            counts.push_back(count);
+        }
+        if (!valid || counts.size() > (mode == "--serve" ? 1u : 3u)) {
+            std::cerr << "Usage: " << argv[0] << " --serve ADDRESS [LOOPS]\n"
+                      << "       " << argv[0] << " --loadgen ADDRESS [CONNECTIONS] [DEPTH] [SECONDS]\n"
+                      << "ADDRESS is a loopback TCP port or unix:PATH.\n";
+            return 1;
+        }
+        counts.resize(3, 0);
+        if (mode == "--loadgen") {
+            return runLoadGen(address, counts[0] > 0 ? counts[0] : 4, counts[1] > 0 ? counts[1] : 32,
+                              counts[2] > 0 ? counts[2] : 5);
+        }
+        Hotel hotel;
+        if (hotel.hasSavedState()) {
+            hotel.loadData();
+        }
+        return runServer(hotel, address, counts[0] > 0 ? counts[0] : 1);
+    }
+#endif
+    if (argc >= 2 && std::string(argv[1]) == "--stress") {
+        // --stress [THREADS] [OPS_PER_THREAD]
+        size_t counts[2] = {std::max<size_t>(4, std::thread::hardware_concurrency()), 200000};
+        for (int i = 2; i < argc; ++i) {
+            if (i > 3 || !parseInt(std::string_view(argv[i]), counts[i - 2]) || counts[i - 2] == 0) {
+                std::cerr << "Usage: " << argv[0] << " --stress [THREADS] [OPS_PER_THREAD]\n";
+                return 1;
+            }
+        }
+        return runStress(counts[0], counts[1]);
+    }
+
     Hotel hotel;
+    hotel.enableAnalytics();
     int choice;
 
     do {
@@ -279,6 +4311,14 @@ int main() {
         std::cout << "6. Show List of Customers\n";
         std::cout << "7. Save Data\n";
         std::cout << "8. Load Data\n";
+        std::cout << "9. Book Any Room of a Type\n";
+        std::cout << "10. Reserve Room for Dates\n";
+        std::cout << "11. Cancel Reservation\n";
+        std::cout << "12. Find Free Rooms for Dates\n";
+        std::cout << "13. Book a Group of Rooms\n";
+        std::cout << "14. Cancel Group Booking\n";
+        std::cout << "15. Booking Report for Dates\n";
+        std::cout << "16. Show Booking History of a Customer\n";
         std::cout << "0. Exit\n";
         std::cout << "Enter your choice: ";
         std::cin >> choice;
@@ -286,18 +4326,15 @@ int main() {
         switch (choice) {
         case 1: {
             int roomNumber;
-            std::string roomType;
+            std::string typeName;
+            RoomType roomType;
             std::cout << "Enter Room Number: ";
             std::cin >> roomNumber;
                         std::cout << "Enter Room Type (Single/Double/Suite): ";
-            std::cin >> roomType;
-
-            if (roomType == "Single") {
-                hotel.addRoom(new SingleRoom(roomNumber));
-            } else if (roomType == "Double") {
-                hotel.addRoom(new DoubleRoom(roomNumber));
-            } else if (roomType == "Suite") {
-                hotel.addRoom(new SuiteRoom(roomNumber));
+            std::cin >> typeName;
+
+            if (parseRoomType(typeName, roomType)) {
+                hotel.addRoom(Room(roomNumber, roomType));
             } else {
                 std::cout << "Invalid room type!\n";
             }
@@ -340,9 +4377,22 @@ int main() {
             }
             break;
         }
-        case 5:
-            hotel.checkAvailability();
+        case 5: {
+            std::string typeName;
+            char availableOnly;
+            size_t page;
+            RoomFilter filter;
+            std::cout << "Enter Room Type (Single/Double/Suite/All): ";
+            std::cin >> typeName;
+            std::cout << "Only available rooms? (y/n): ";
+            std::cin >> availableOnly;
+            std::cout << "Enter Page Number (starting at 1): ";
+            std::cin >> page;
+            filter.allTypes = !parseRoomType(typeName, filter.roomType);
+            filter.availableOnly = availableOnly == 'y' || availableOnly == 'Y';
+            hotel.checkAvailability(filter, page > 0 ? page - 1 : 0);
             break;
+        }
         case 6:
             hotel.showCustomers();
             break;
@@ -352,6 +4402,129 @@ int main() {
         case 8:
             hotel.loadData();
             break;
+        case 9: {
+            std::string typeName;
+            RoomType roomType;
+            int customerID;
+            std::cout << "Enter Room Type (Single/Double/Suite): ";
+            std::cin >> typeName;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerID;
+            if (!parseRoomType(typeName, roomType)) {
+                std::cout << "Invalid room type!\n";
+                break;
+            }
+            try {
+                hotel.bookAnyRoom(roomType, customerID);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            break;
+        }
+        case 10:
+        case 11: {
+            int roomNumber, customerID, checkIn, checkOut = 0;
+            std::string from, to;
+            std::cout << "Enter Room Number: ";
+            std::cin >> roomNumber;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerID;
+            std::cout << "Enter Check-in Date (YYYY-MM-DD): ";
+            std::cin >> from;
+            if (choice == 10) {
+                std::cout << "Enter Check-out Date (YYYY-MM-DD): ";
+                std::cin >> to;
+            }
+            if (!parseDate(from, checkIn) || (choice == 10 && !parseDate(to, checkOut))) {
+                std::cout << "Invalid date!\n";
+                break;
+            }
+            try {
+                if (choice == 10) {
+                    hotel.reserveRoom(roomNumber, customerID, checkIn, checkOut);
+                } else {
+                    hotel.cancelReservation(roomNumber, customerID, checkIn);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            break;
+        }
+        case 12: {
+            std::string typeName, from, to;
+            RoomType roomType;
+            int checkIn, checkOut;
+            std::cout << "Enter Room Type (Single/Double/Suite): ";
+            std::cin >> typeName;
+            std::cout << "Enter Check-in Date (YYYY-MM-DD): ";
+            std::cin >> from;
+            std::cout << "Enter Check-out Date (YYYY-MM-DD): ";
+            std::cin >> to;
+            if (!parseRoomType(typeName, roomType) || !parseDate(from, checkIn) || !parseDate(to, checkOut)) {
+                std::cout << "Invalid room type or date!\n";
+                break;
+            }
+            std::vector<int> freeRooms = hotel.findFreeRooms(roomType, checkIn, checkOut);
+            std::cout << "\nFree " << typeName << " rooms from " << from << " to " << to << ":\n";
+            for (int roomNumber : freeRooms) {
+                std::cout << "Room Number: " << roomNumber << std::endl;
+            }
+            std::cout << freeRooms.size() << " room(s).\n";
+            break;
+        }
+        case 13: {
+            int customerID;
+            size_t count;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerID;
+            std::cout << "Enter Number of Rooms: ";
+            std::cin >> count;
+            std::vector<int> roomNumbers(count);
+            std::cout << "Enter Room Numbers: ";
+            for (auto& roomNumber : roomNumbers) {
+                std::cin >> roomNumber;
+            }
+            try {
+                hotel.bookRooms(customerID, roomNumbers);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            break;
+        }
+        case 14: {
+            int groupID, customerID;
+            std::cout << "Enter Group ID: ";
+            std::cin >> groupID;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerID;
+            try {
+                hotel.cancelGroupBooking(groupID, customerID);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            break;
+        }
+        case 15: {
+            std::string from, to;
+            int firstDay, lastDay;
+            std::cout << "Enter First Night (YYYY-MM-DD): ";
+            std::cin >> from;
+            std::cout << "Enter Last Night (YYYY-MM-DD): ";
+            std::cin >> to;
+            if (!parseDate(from, firstDay) || !parseDate(to, lastDay) || lastDay < firstDay) {
+                std::cout << "Invalid date!\n";
+                break;
+            }
+            hotel.printReport(firstDay, lastDay + 1);
+            break;
+        }
+        case 16: {
+            int customerID;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerID;
+            hotel.showBookingHistory(customerID);
+            break;
+        }
         case 0:
             std::cout << "Exiting...\n";
             break;